@@ -36,19 +36,32 @@ int main(int argc, char* argv[]) {
 
 	AssemblyProgram* program = reader->assemble();
 
-	printf("Assembly complete, cleaning up ...\n");
-	printf("Found %d literal values.\n", program->countInt64Literals() );
+	const bool verbose = options->isVerbose();
+
+	if( verbose ) {
+		printf("Assembly complete, cleaning up ...\n");
+		printf("Found %d literal values.\n", program->countInt64Literals() );
+	}
 
 	bool labelsOK = program->verifyLabels();
 
-	if( labelsOK ) {
+	if( labelsOK && verbose ) {
 		printf("All labels checkout OK.\n");
-	} 
+	}
 
-	printf("Writing binary...\n");
-	program->writeBinary( options->getOutputFile() );
+	if( verbose ) {
+		printf("Writing binary...\n");
+	}
 
-	printf("Completed.\n");
+	if( options->isSectioned() ) {
+		program->writeSectionedBinary( options->getOutputFile() );
+	} else {
+		program->writeBinary( options->getOutputFile() );
+	}
+
+	if( verbose ) {
+		printf("Completed.\n");
+	}
 
 	delete program;
 	delete reader;
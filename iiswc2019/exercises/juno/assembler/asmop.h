@@ -23,6 +23,7 @@
 #include <cinttypes>
 #include <cstring>
 #include <string>
+#include <unordered_map>
 
 namespace SST {
 namespace Juno {
@@ -32,155 +33,129 @@ enum AssemblyOperandType {
 	REGISTER_OPERAND = 0,
 	MEMORY_OPERAND = 1,
 	LITERAL_OPERAND = 2,
-	LABEL_OPERAND = 4
+	LABEL_OPERAND = 4,
+	// $NAME, a literal holding the address of a label in the data segment
+	DATA_ADDRESS_OPERAND = 8
 };
 
-class AssemblyOperand {
-public:
-	AssemblyOperand() {}
-	virtual AssemblyOperandType getType() = 0;
+// Mnemonics known to the assembler, looked up once when an operation is
+// parsed so encoding can switch on them
+enum AssemblyMnemonic {
+	ASM_UNKNOWN = 0,
+	ASM_ADD,
+	ASM_SUB,
+	ASM_MUL,
+	ASM_DIV,
+	ASM_MOD,
+	ASM_AND,
+	ASM_OR,
+	ASM_XOR,
+	ASM_NOT,
+	ASM_JZERO,
+	ASM_JLTZ,
+	ASM_JGTZ,
+	ASM_LDA,
+	ASM_STA,
+	ASM_LOAD,
+	ASM_STORE,
+	ASM_VLOAD,
+	ASM_VGATHER,
+	ASM_VSTORE,
+	ASM_RAND,
+	ASM_RSEED,
+	ASM_HALT
 };
 
-class AssemblyLabelOperand : public AssemblyOperand {
-public:
-	AssemblyLabelOperand( char* label ):
-		labelText(label) {}
-	~AssemblyLabelOperand() {}
+// Names of the mnemonics, indexed by AssemblyMnemonic
+static const char* const asmMnemonicNames[] = {
+	"UNKNOWN", "ADD", "SUB", "MUL", "DIV", "MOD", "AND", "OR", "XOR", "NOT",
+	"JZERO", "JLTZ", "JGTZ", "LDA", "STA", "LOAD", "STORE",
+	"VLOAD", "VGATHER", "VSTORE", "RAND", "RSEED", "HALT"
+};
 
-	AssemblyOperandType getType() {
-		return LABEL_OPERAND;
-	}
+inline std::unordered_map<std::string, AssemblyMnemonic> buildMnemonicTable() {
+	std::unordered_map<std::string, AssemblyMnemonic> mnemonics;
 
-	const std::string& getLabel() const {
-		return labelText;
+	for( int i = ASM_ADD; i <= ASM_HALT; ++i ) {
+		mnemonics.insert( std::pair<std::string, AssemblyMnemonic>( asmMnemonicNames[i],
+			static_cast<AssemblyMnemonic>(i) ) );
 	}
 
-protected:
-	std::string labelText;
-};
-
-class AssemblyRegisterOperand : public AssemblyOperand {
-	#define JUNO_MAX_REGISTER_DIGITS 6
-public:
-	AssemblyRegisterOperand(const uint8_t regst) :
-		AssemblyOperand(), reg(regst) {}
-	AssemblyRegisterOperand(const char* regst) :
-		AssemblyOperand() {
-
-		if(strlen(regst) == 0) {
-			fprintf(stderr, "Error: register number is empty.\n");
-			exit(-1);
-		}
-
-		if( strlen(regst) > JUNO_MAX_REGISTER_DIGITS || strlen(regst) == 1 ) {
-			fprintf(stderr, "Error: register number (%s) is badly formed.\n", regst);
-			exit(-1);
-		}
+	return mnemonics;
+}
 
-		if( ! (regst[0] == 'r' || regst[0] == 'R') ) {
-			fprintf(stderr, "Error: register badly formed - must start with r. (%s)\n", regst);
-			exit(-1);
-		}
+inline AssemblyMnemonic lookupMnemonic( const char* instMnu, const size_t instLen ) {
+	static const std::unordered_map<std::string, AssemblyMnemonic> mnemonics = buildMnemonicTable();
 
-		char regNum[JUNO_MAX_REGISTER_DIGITS];
-		for(int i = 1; i < std::max(static_cast<size_t>(JUNO_MAX_REGISTER_DIGITS), strlen(regst)); ++i) {
-			regNum[i-1] = regst[i];
-		}
+	auto mnuItr = mnemonics.find( std::string( instMnu, instLen ) );
+	return (mnuItr == mnemonics.end()) ? ASM_UNKNOWN : mnuItr->second;
+}
 
-		reg = static_cast<uint8_t>( std::atoi(regNum) );
-		printf("Register: %" PRIu8 "\n", reg);
-	}
+// Operands are held by value in their operation. The value is the
+// register number, the literal, the address or, for labels, the id the
+// program gave the label's name.
+class AssemblyOperand {
+public:
+	AssemblyOperand() : type(REGISTER_OPERAND), value(0) {}
+	AssemblyOperand( const AssemblyOperandType opType, const int64_t opValue ) :
+		type(opType), value(opValue) {}
 
-	AssemblyOperandType getType() { return REGISTER_OPERAND; }
-	uint8_t getRegister() { return reg; }
+	AssemblyOperandType getType() const { return type; }
+	uint8_t getRegister() const { return static_cast<uint8_t>(value); }
+	int64_t getLiteral() const { return value; }
+	uint64_t getAddress() const { return static_cast<uint64_t>(value); }
+	uint32_t getLabelId() const { return static_cast<uint32_t>(value); }
 
 protected:
-	uint8_t reg;
+	AssemblyOperandType type;
+	int64_t value;
 };
 
-class AssemblyLiteralOperand : public AssemblyOperand {
-public:
-	AssemblyLiteralOperand(const int64_t literal) :
-		AssemblyOperand(), val(literal) {}
-
-	AssemblyLiteralOperand(const char* litStr) :
-		AssemblyOperand() {
+#define JUNO_ASM_MAX_OPERANDS 3
+// Longest register operand, including the leading r
+#define JUNO_MAX_REGISTER_DIGITS 6
 
-		if(strlen(litStr) == 0) {
-			fprintf(stderr, "Error: literal value is empty.\n");
-			exit(-1);
-		}
-
-		if(strlen(litStr) == 1) {
-			fprintf(stderr, "Error: literal value is not long enough!\n");
-			exit(-1);
-		}
+class AssemblyOperation {
 
-		if( '$' != litStr[0] ) {
-			fprintf(stderr, "Error: literal value does not start with a $\n");
-			exit(-1);
-		}
+public:
+	AssemblyOperation( const AssemblyMnemonic instMnu, const uint32_t srcLine ) :
+		mnemonic(instMnu), operandCount(0), line(srcLine) {}
 
-		char* literalValue = (char*) malloc( sizeof(char) * 128 );
-		for(int i = 1; i < 128; ++i) {
-			literalValue[i-1] = litStr[i];
+	// False when the operation already holds JUNO_ASM_MAX_OPERANDS
+	bool addOperand( const AssemblyOperand& op ) {
+		if( operandCount >= JUNO_ASM_MAX_OPERANDS ) {
+			return false;
 		}
 
-		val = static_cast<int64_t>( std::atoll(literalValue) );
-		printf("Literal: %" PRId64 "\n", val);
+		operands[operandCount++] = op;
+		return true;
 	}
 
-	AssemblyOperandType getType() { return LITERAL_OPERAND; }
-	int64_t getLiteral() { return val; }
-
-protected:
-	int64_t val;
-	uint64_t valIndex;
-};
-
-class AssemblyMemoryOperand : public AssemblyOperand {
-public:
-	AssemblyMemoryOperand(const uint64_t address) :
-		AssemblyOperand(), addr(address) {}
-	AssemblyMemoryOperand(const char* addrStr) :
-		AssemblyOperand() {
-
-		char* num_end;
-		addr = static_cast<uint64_t>( std::strtoull(addrStr, &num_end, 10) );
+	int countOperands() const {
+		return static_cast<int>( operandCount );
 	}
 
-	uint64_t getAddress() { return addr; }
-	AssemblyOperandType getType() { return MEMORY_OPERAND; }
-
-protected:
-	uint64_t addr;
-};
-
-class AssemblyOperation {
-
-public:
-	AssemblyOperation(const char* instMnu) : instCode(instMnu) {}
-	~AssemblyOperation() {}
-
-	void addOperand(AssemblyOperand* op) {
-		operands.push_back(op);
+	const AssemblyOperand& getOperand(const int i) const {
+		return operands[i];
 	}
 
-	int countOperands() {
-		return static_cast<int>( operands.size() );
+	const char* getInstCode() const {
+		return asmMnemonicNames[mnemonic];
 	}
 
-	AssemblyOperand* getOperand(const int i) {
-		return operands.at(i);
+	AssemblyMnemonic getMnemonic() const {
+		return mnemonic;
 	}
 
-	std::string getInstCode() {
-		return instCode;
+	uint32_t getLine() const {
+		return line;
 	}
 
 protected:
-	const std::string instCode;
-	std::vector<AssemblyOperand*> operands;
+	AssemblyMnemonic mnemonic;
+	uint8_t operandCount;
+	uint32_t line;
+	AssemblyOperand operands[JUNO_ASM_MAX_OPERANDS];
 
 };
 
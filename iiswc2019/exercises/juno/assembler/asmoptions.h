@@ -31,6 +31,8 @@ public:
 	AssemblerOptions(const int argc, char* argv[]) {
 		outputFilePath = "program.bin";
 		inputFilePath.clear();
+		verbose = false;
+		sectioned = false;
 
 		for(int i = 1; i < argc; ++i) {
 			if( 0 == strcmp("-o", argv[i]) ) {
@@ -51,14 +53,20 @@ public:
 					fprintf(stderr, "Error: specified -i but did not provide an input path.\n");
 					exit(-1);
 				}
+			} else if( 0 == strcmp("-v", argv[i]) ) {
+				verbose = true;
+			} else if( 0 == strcmp("-s", argv[i]) ) {
+				sectioned = true;
 			} else if(  0 == strcmp("-help", argv[i]) ||
 						0 == strcmp("--help", argv[i]) ||
 						0 == strcmp("-h", argv[i]) ) {
 
-				printf("sst-juno-asm [-i <input file>] [-o <output file>]\n");
+				printf("sst-juno-asm [-i <input file>] [-o <output file>] [-v] [-s]\n");
 				printf("\n");
 				printf("<input file>   File to read in, if not specified stdin\n");
 				printf("<output file>  File to write to, if not specified program.bin\n");
+				printf("-v             Print each line, operand and encoding as it is assembled\n");
+				printf("-s             Write the sectioned format with symbol and line tables\n");
 				printf("\n");
 				exit(0);
 			} else {
@@ -88,6 +96,8 @@ public:
 
 		inputFile = stdin;
 		outputFile = stdout;
+		verbose = false;
+		sectioned = false;
 	}
 
 	~AssemblerOptions() {
@@ -144,11 +154,21 @@ public:
 		return outputFilePath;
 	}
 
+	bool isVerbose() const {
+		return verbose;
+	}
+
+	bool isSectioned() const {
+		return sectioned;
+	}
+
 protected:
 	FILE* inputFile;
 	FILE* outputFile;
 	std::string inputFilePath;
 	std::string outputFilePath;
+	bool verbose;
+	bool sectioned;
 
 };
 
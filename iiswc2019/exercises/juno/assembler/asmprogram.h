@@ -23,124 +23,202 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <cinttypes>
 #include <cstdint>
+#include <algorithm>
 
 namespace SST {
 namespace Juno {
 namespace Assembler {
 
+// Marks a label which has been referenced but not yet defined
+#define JUNO_ASM_LABEL_UNDEFINED UINT64_MAX
+
+// Binary versions, the sparse one is only written when the data segment
+// has BSS (.zero) so other programs still load on readers of the dense one
+#define JUNO_ASM_BINARY_DENSE  1000000
+#define JUNO_ASM_BINARY_SPARSE 1000001
+
+// Sectioned version written with -s, a section table follows the header
+// and symbol and line tables travel with the program
+#define JUNO_ASM_BINARY_SECTIONED 2000000
+
+#define JUNO_ASM_SECTION_TEXT    1
+#define JUNO_ASM_SECTION_DATA    2
+#define JUNO_ASM_SECTION_BSS     3
+#define JUNO_ASM_SECTION_SYMBOLS 4
+#define JUNO_ASM_SECTION_LINES   5
+
+#define JUNO_ASM_SYMBOL_CODE 0
+#define JUNO_ASM_SYMBOL_DATA 1
+
+// Initialized words of the data segment, count words of dataWords from
+// first placed at byte offset in the segment
+struct AssemblyDataExtent {
+	uint64_t offset;
+	size_t first;
+	size_t count;
+};
+
+// One entry of the sectioned binary's section table, payload is NULL for
+// sections (BSS) which take no space in the file
+struct AssemblySection {
+	uint32_t type;
+	uint32_t reserved;
+	uint64_t addr;
+	uint64_t fileOffset;
+	uint64_t size;
+	const void* payload;
+};
+
 class AssemblyProgram {
 
 public:
-	AssemblyProgram() {
-		op = new std::vector<AssemblyOperation*>();
-	}
+	AssemblyProgram( const bool verboseMode = false ) :
+		verbose(verboseMode), dataSpanWords(0), bssWords(0) {}
 
-	~AssemblyProgram() {
-		delete op;
-	}
+	~AssemblyProgram() {}
 
-	std::vector<AssemblyOperation*>* getOperations() {
+	std::vector<AssemblyOperation>& getOperations() {
 		return op;
 	}
 
-	uint64_t countOperations() {
-		return static_cast<uint64_t>(op->size());
+	uint64_t countOperations() const {
+		return static_cast<uint64_t>(op.size());
+	}
+
+	void reserveOperations( const size_t count ) {
+		op.reserve( count );
 	}
 
-	void addOperation( AssemblyOperation* newOp ) {
-		op->push_back( newOp );
+	void addOperation( const AssemblyOperation& newOp ) {
+		op.push_back( newOp );
 	}
 
 	void collectLiterals() {
-		printf("Collecting literals...\n");
+		if( verbose ) {
+			printf("Collecting literals...\n");
+		}
 
 		int64Literals.clear();
+		literalIndex.clear();
+		dataAddressIndex.clear();
 
-		for( auto opItr = op->begin(); opItr != op->end(); opItr++ ) {
-			AssemblyOperation* curOp = (*opItr);
-
-			printf("INSTRUCTION{%20s][%d operands]\n", curOp->getInstCode().c_str(),
-				curOp->countOperands());
+		for( auto opItr = op.begin(); opItr != op.end(); opItr++ ) {
+			const AssemblyOperation& curOp = (*opItr);
 
-			for( int i = 0 ; i < curOp->countOperands(); ++i ) {
-				printf("-> Operand: Type=%d\n", (int) curOp->getOperand(i)->getType());
+			for( int i = 0 ; i < curOp.countOperands(); ++i ) {
+				if( curOp.getOperand(i).getType() == LITERAL_OPERAND ) {
+					const int64_t litVal = curOp.getOperand(i).getLiteral();
 
-				if( curOp->getOperand(i)->getType() == LITERAL_OPERAND ) {
-					AssemblyLiteralOperand* litOp = dynamic_cast<AssemblyLiteralOperand*>( curOp->getOperand(i) );
-
-					if( NULL == litOp ) {
-						fprintf(stderr, "Error: expected a literal operand but cast failed.\n");
-						exit(-1);
+					// Found a unique literal value
+					if( literalIndex.find( litVal ) == literalIndex.end() ) {
+						literalIndex.insert( std::pair<int64_t, int>( litVal, static_cast<int>(int64Literals.size()) ) );
+						int64Literals.push_back( litVal );
 					}
+				} else if( curOp.getOperand(i).getType() == DATA_ADDRESS_OPERAND ) {
+					const uint32_t labelId = curOp.getOperand(i).getLabelId();
 
-					const int64_t litVal = litOp->getLiteral();
+					// Slot is filled once the size of the pool is known
+					if( dataAddressIndex.find( labelId ) == dataAddressIndex.end() ) {
+						dataAddressIndex.insert( std::pair<uint32_t, int>( labelId, static_cast<int>(int64Literals.size()) ) );
+						int64Literals.push_back( 0 );
+					}
+				}
+			}
+		}
 
-					printf("Searching for literal value: %" PRId64 "...\n", litVal);
+		// The data segment follows the literal pool
+		const uint64_t dataBase = static_cast<uint64_t>(int64Literals.size()) * 8;
 
-					int index = -1;
+		for( auto addrItr = dataAddressIndex.begin(); addrItr != dataAddressIndex.end(); addrItr++ ) {
+			int64Literals[addrItr->second] = static_cast<int64_t>( dataBase + labelLocs[addrItr->first] );
+		}
 
-					for( int j = 0; j < int64Literals.size(); ++j ) {
-						if( litVal == int64Literals[j] ) {
-							index = j;
-							break;
-						}
-					}
+		if( verbose ) {
+			printf("Literal collection done (collected: %" PRIu64 " literals)\n",
+				static_cast<uint64_t>(int64Literals.size()));
+		}
+	}
 
-					printf("Index: %d\n", index);
+	// Id for a label name, given out on first use whether that is the
+	// definition or a jump to it
+	uint32_t getLabelId( const char* labelText, const size_t labelLen ) {
+		const std::string label( labelText, labelLen );
+		auto labelItr = labelIds.find( label );
 
-					// Found a unique literal value
-					if( -1 == index ) {
-						int64Literals.push_back( litVal );
-					}
-				}
-			}
+		if( labelItr != labelIds.end() ) {
+			return labelItr->second;
 		}
 
-		printf("Literal collection done (collected: %" PRIu64 " literals)\n",
-			static_cast<uint64_t>(int64Literals.size()));
+		const uint32_t newId = static_cast<uint32_t>( labelNames.size() );
+
+		labelIds.insert( std::pair<std::string, uint32_t>( label, newId ) );
+		labelNames.push_back( label );
+		labelLocs.push_back( JUNO_ASM_LABEL_UNDEFINED );
+		labelIsData.push_back( false );
+
+		return newId;
+	}
+
+	void addLabel( const char* labelText, const size_t labelLen, const uint64_t loc ) {
+		defineLabel( labelText, labelLen, loc, false );
 	}
 
-	void addLabel( const std::string labelText, const uint64_t loc ) {
-		auto checkExists = labelMap.find(labelText);
+	// Data labels are located by their byte offset into the data segment
+	void addDataLabel( const char* labelText, const size_t labelLen ) {
+		defineLabel( labelText, labelLen, dataSpanWords * 8, true );
+	}
+
+	void defineLabel( const char* labelText, const size_t labelLen, const uint64_t loc, const bool isData ) {
+		const uint32_t labelId = getLabelId( labelText, labelLen );
 
-		if( checkExists == labelMap.end() ) {
-			labelMap.insert( std::pair<std::string, uint64_t>(labelText, loc) );
+		if( JUNO_ASM_LABEL_UNDEFINED == labelLocs[labelId] ) {
+			labelLocs[labelId]   = loc;
+			labelIsData[labelId] = isData;
 		} else {
-			fprintf(stderr, "Error: label \"%s\" is defined twice in this program.\n", labelText.c_str() );
+			fprintf(stderr, "Error: label \"%s\" is defined twice in this program.\n", labelNames[labelId].c_str() );
 			exit(-1);
 		}
 	}
 
 	bool verifyLabels() {
-		printf("Verifying labels...\n");
+		if( verbose ) {
+			printf("Verifying labels...\n");
+		}
+
 		bool foundAll = true;
 
-		for( auto opItr = op->begin(); opItr != op->end(); opItr++ ) {
-			AssemblyOperation* curOp = (*opItr);
+		for( size_t i = 0; i < labelLocs.size(); ++i ) {
+			if( JUNO_ASM_LABEL_UNDEFINED == labelLocs[i] ) {
+				fprintf(stderr, "Error: did not find label \"%s\" in program.\n", labelNames[i].c_str());
+				foundAll = false;
+			}
+		}
 
-			for( int j = 0; j < curOp->countOperands(); ++j ) {
-				if( LABEL_OPERAND == curOp->getOperand(j)->getType() ) {
-					AssemblyLabelOperand* labelOp = dynamic_cast<AssemblyLabelOperand*>( curOp->getOperand(j) );
+		if( verbose ) {
+			printf("Completed checking labels\n");
+		}
 
-					if( NULL == labelOp ) {
-						fprintf(stderr, "Error: attempted to convert a LABEL_OPERAND to object but failed.\n");
-						exit(-1);
-					}
+		// Jumps go to code labels and $NAME takes the address of data labels
+		for( auto opItr = op.begin(); opItr != op.end(); opItr++ ) {
+			for( int j = 0; j < opItr->countOperands(); ++j ) {
+				const AssemblyOperand& curOperand = opItr->getOperand(j);
+				const bool wantData = (DATA_ADDRESS_OPERAND == curOperand.getType());
 
-					const std::string& labelStr = labelOp->getLabel();
+				if( (LABEL_OPERAND == curOperand.getType() || wantData) &&
+					JUNO_ASM_LABEL_UNDEFINED != labelLocs[curOperand.getLabelId()] &&
+					wantData != labelIsData[curOperand.getLabelId()] ) {
 
-					if( labelMap.find(labelStr) == labelMap.end() ) {
-						fprintf(stderr, "Error: did not find label \"%s\" in program.\n", labelStr.c_str());
-						foundAll = false;
-					}
+					fprintf(stderr, "Error: line %" PRIu32 " uses \"%s\" as a %s label but it is defined as a %s label.\n",
+						opItr->getLine(), labelNames[curOperand.getLabelId()].c_str(),
+						wantData ? "data" : "code", wantData ? "code" : "data");
+					foundAll = false;
 				}
 			}
 		}
 
-		printf("Completed checking labels\n");
-
 		if( ! foundAll ) {
 			fprintf(stderr, "Error: could not find all labels in the program.\n");
 			exit(-1);
@@ -157,69 +235,270 @@ public:
 		return int64Literals.at( index );
 	}
 
+	// Position of a collected literal in the pool, or -1 if it was not seen
+	int findInt64Literal( const int64_t litVal ) const {
+		auto litItr = literalIndex.find( litVal );
+		return (litItr == literalIndex.end()) ? -1 : litItr->second;
+	}
+
+	int findLiteral( const AssemblyOperand& litOp ) const {
+		if( DATA_ADDRESS_OPERAND == litOp.getType() ) {
+			auto addrItr = dataAddressIndex.find( litOp.getLabelId() );
+			return (addrItr == dataAddressIndex.end()) ? -1 : addrItr->second;
+		}
+
+		return findInt64Literal( litOp.getLiteral() );
+	}
+
+	void addDataWord( const int64_t value ) {
+		addDataWords( 1, value );
+	}
+
+	void addDataWords( const uint64_t count, const int64_t value ) {
+		if( 0 == count ) {
+			return;
+		}
+
+		if( dataExtents.empty() || (dataExtents.back().offset / 8) + dataExtents.back().count != dataSpanWords ) {
+			AssemblyDataExtent newExtent = { dataSpanWords * 8, dataWords.size(), 0 };
+			dataExtents.push_back( newExtent );
+		}
+
+		dataWords.insert( dataWords.end(), static_cast<size_t>(count), value );
+		dataExtents.back().count += static_cast<size_t>(count);
+		dataSpanWords += count;
+	}
+
+	// Zero words which take space in the data segment but not the binary
+	void addZeroWords( const uint64_t count ) {
+		dataSpanWords += count;
+		bssWords      += count;
+	}
+
+	uint64_t countDataWords() const {
+		return dataSpanWords;
+	}
+
 	void writeBinary( FILE* binary ) {
-		const int64_t  BINARY_VERSION = 1000000;
-		const uint64_t literalSize = static_cast<uint64_t>(int64Literals.size()) * 8;
-		const uint64_t programSize = static_cast<uint64_t>(op->size()) * 4;
+		const int64_t  BINARY_VERSION = (0 == bssWords) ? JUNO_ASM_BINARY_DENSE : JUNO_ASM_BINARY_SPARSE;
+		const uint64_t literalBytes = static_cast<uint64_t>(int64Literals.size()) * 8;
+		const uint64_t literalSize = literalBytes + (dataSpanWords * 8);
+		const uint64_t programSize = static_cast<uint64_t>(op.size()) * 4;
 
 		// Write out the header file
 		fwrite( &BINARY_VERSION, sizeof(BINARY_VERSION), 1, binary );
 		fwrite( &literalSize, sizeof(literalSize), 1, binary );
 		fwrite( &programSize, sizeof(programSize), 1, binary );
 
+		if( verbose ) {
+			printf("Data segment: %" PRIu64 " bytes, %" PRIu64 " of them BSS\n", literalSize, bssWords * 8);
+		}
+
+		if( JUNO_ASM_BINARY_SPARSE == BINARY_VERSION ) {
+			// Extent table, the literal pool then each initialized run
+			const uint64_t extentCount = static_cast<uint64_t>(dataExtents.size()) + (int64Literals.empty() ? 0 : 1);
+			fwrite( &extentCount, sizeof(extentCount), 1, binary );
+
+			if( ! int64Literals.empty() ) {
+				const uint64_t poolAddr = 0;
+				fwrite( &poolAddr, sizeof(poolAddr), 1, binary );
+				fwrite( &literalBytes, sizeof(literalBytes), 1, binary );
+			}
+
+			for( size_t i = 0; i < dataExtents.size(); ++i ) {
+				const uint64_t extentAddr = literalBytes + dataExtents[i].offset;
+				const uint64_t extentLen  = static_cast<uint64_t>(dataExtents[i].count) * 8;
+
+				fwrite( &extentAddr, sizeof(extentAddr), 1, binary );
+				fwrite( &extentLen, sizeof(extentLen), 1, binary );
+			}
+		}
+
 		for( int i = 0; i < int64Literals.size(); ++i ) {
 			fwrite( &int64Literals[i], sizeof(int64_t), 1, binary );
 		}
 
+		// Extents are in address order, back to back they are the dense
+		// data when there is no BSS
+		if( ! dataWords.empty() ) {
+			fwrite( dataWords.data(), sizeof(int64_t), dataWords.size(), binary );
+		}
+
 		char binaryOp[4];
 
-		for( int i = 0; i < op->size(); ++i ) {
-			for( int j = 0; j < 4; ++j ) {
-				binaryOp[j] = 0;
+		for( int i = 0; i < op.size(); ++i ) {
+			encodeOperation( i, binaryOp );
+			fwrite( &binaryOp[0], sizeof(char), 4, binary );
+		}
+	}
+
+	// Header, section table then the 8-byte aligned payloads of each
+	// section in table order
+	void writeSectionedBinary( FILE* binary ) {
+		const int64_t  BINARY_VERSION = JUNO_ASM_BINARY_SECTIONED;
+		const uint64_t literalBytes = static_cast<uint64_t>(int64Literals.size()) * 8;
+		const uint64_t literalSize = literalBytes + (dataSpanWords * 8);
+		const uint64_t programSize = static_cast<uint64_t>(op.size()) * 4;
+
+		std::vector<char> text( static_cast<size_t>(programSize) );
+
+		for( size_t i = 0; i < op.size(); ++i ) {
+			encodeOperation( static_cast<int>(i), &text[ i * 4 ] );
+		}
+
+		std::vector<char> symbols;
+		std::vector<char> lines;
+		buildSymbolTable( literalSize, literalBytes, symbols );
+		buildLineTable( lines );
+
+		std::vector<AssemblySection> sections;
+
+		if( ! int64Literals.empty() ) {
+			addSection( sections, JUNO_ASM_SECTION_DATA, 0, literalBytes, int64Literals.data() );
+		}
+
+		// Gaps between the initialized extents are BSS
+		uint64_t nextAddr = literalBytes;
+
+		for( size_t i = 0; i < dataExtents.size(); ++i ) {
+			const uint64_t extentAddr = literalBytes + dataExtents[i].offset;
+			const uint64_t extentLen  = static_cast<uint64_t>(dataExtents[i].count) * 8;
+
+			if( 0 == extentLen ) {
+				continue;
+			}
+
+			if( extentAddr > nextAddr ) {
+				addSection( sections, JUNO_ASM_SECTION_BSS, nextAddr, extentAddr - nextAddr, NULL );
+			}
+
+			addSection( sections, JUNO_ASM_SECTION_DATA, extentAddr, extentLen, &dataWords[ dataExtents[i].first ] );
+			nextAddr = extentAddr + extentLen;
+		}
+
+		if( literalSize > nextAddr ) {
+			addSection( sections, JUNO_ASM_SECTION_BSS, nextAddr, literalSize - nextAddr, NULL );
+		}
+
+		addSection( sections, JUNO_ASM_SECTION_TEXT, literalSize, programSize, text.data() );
+		addSection( sections, JUNO_ASM_SECTION_SYMBOLS, 0, symbols.size(), symbols.data() );
+		addSection( sections, JUNO_ASM_SECTION_LINES, 0, lines.size(), lines.data() );
+
+		const uint64_t sectionCount = static_cast<uint64_t>( sections.size() );
+		uint64_t fileOffset = (4 * 8) + (sectionCount * 32);
+
+		for( size_t i = 0; i < sections.size(); ++i ) {
+			if( NULL != sections[i].payload ) {
+				sections[i].fileOffset = fileOffset;
+				fileOffset += (sections[i].size + 7) & ~static_cast<uint64_t>(7);
 			}
+		}
+
+		fwrite( &BINARY_VERSION, sizeof(BINARY_VERSION), 1, binary );
+		fwrite( &literalSize, sizeof(literalSize), 1, binary );
+		fwrite( &programSize, sizeof(programSize), 1, binary );
+		fwrite( &sectionCount, sizeof(sectionCount), 1, binary );
+
+		for( size_t i = 0; i < sections.size(); ++i ) {
+			fwrite( &sections[i].type, sizeof(uint32_t), 1, binary );
+			fwrite( &sections[i].reserved, sizeof(uint32_t), 1, binary );
+			fwrite( &sections[i].addr, sizeof(uint64_t), 1, binary );
+			fwrite( &sections[i].fileOffset, sizeof(uint64_t), 1, binary );
+			fwrite( &sections[i].size, sizeof(uint64_t), 1, binary );
+		}
 
-			AssemblyOperation* curOp = op->at(i);
-
-			if( curOp->getInstCode() == "ADD" ) {
-				generateBinaryOperand( JUNO_ADD, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "SUB" ) {
-				generateBinaryOperand( JUNO_SUB, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "MUL" ) {
-				generateBinaryOperand( JUNO_MUL, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "DIV" ) {
-				generateBinaryOperand( JUNO_DIV, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "MOD" ) {
-				generateBinaryOperand( JUNO_MOD, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "AND" ) {
-				generateBinaryOperand( JUNO_AND, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "OR" ) {
-				generateBinaryOperand( JUNO_OR, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "XOR" ) {
-				generateBinaryOperand( JUNO_XOR, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "NOT" ) {
-				// Yes, this uses the binaryOp array but it sets unused fields to zero
-				generateUnaryOperand( JUNO_NOT, curOp, binaryOp );
-//			} else if( curOp->getInstCode() == "JUMP" ) {
-//				generatePCRJump( JUNO_PCR_JUMP, curOp, binaryOp, static_cast<uint64_t>(i) );
-			} else if( curOp->getInstCode() == "JZERO" ) {
-				generatePCRRegJump( JUNO_PCR_JUMP_ZERO, curOp, binaryOp, static_cast<uint64_t>(i) );
-			} else if( curOp->getInstCode() == "JLTZ" ) {
-				generatePCRRegJump( JUNO_PCR_JUMP_LTZ, curOp, binaryOp, static_cast<uint64_t>(i) );
-			} else if( curOp->getInstCode() == "JGTZ" ) {
-				generatePCRRegJump( JUNO_PCR_JUMP_GTZ, curOp, binaryOp, static_cast<uint64_t>(i) );
-			} else if( curOp->getInstCode() == "LDA" ) {
-				generateLoadAddr( JUNO_LOAD_ADDR, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "STA" ) {
-				generateLoadAddr( JUNO_STORE_ADDR, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "LOAD" ) {
-				generateLoad( JUNO_LOAD, curOp, binaryOp );
-			} else if (curOp->getInstCode() == "RAND" ) {
-				generateRand( JUNO_RAND, curOp, binaryOp );
-			} else if (curOp->getInstCode() == "RSEED" ) {
-				generateRandSeed(JUNO_RSEED, curOp, binaryOp );
-			} else if (curOp->getInstCode() == "STORE" ) {
-				generateStore( JUNO_STORE, curOp, binaryOp );
-			} else if( curOp->getInstCode() == "HALT" ) {
+		const char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+		for( size_t i = 0; i < sections.size(); ++i ) {
+			if( NULL != sections[i].payload ) {
+				fwrite( sections[i].payload, sizeof(char), sections[i].size, binary );
+				fwrite( padding, sizeof(char), ((sections[i].size + 7) & ~static_cast<uint64_t>(7)) - sections[i].size, binary );
+			}
+		}
+
+		if( verbose ) {
+			printf("Sectioned binary: %" PRIu64 " sections, %" PRIu64 " bytes\n", sectionCount, fileOffset);
+		}
+	}
+
+	// Fills binaryOp with the four byte encoding of operation i
+	void encodeOperation( const int i, char* binaryOp ) {
+		for( int j = 0; j < 4; ++j ) {
+			binaryOp[j] = 0;
+		}
+
+		const AssemblyOperation* curOp = &op[i];
+
+		switch( curOp->getMnemonic() ) {
+		case ASM_ADD:
+			generateBinaryOperand( JUNO_ADD, curOp, binaryOp );
+			break;
+		case ASM_SUB:
+			generateBinaryOperand( JUNO_SUB, curOp, binaryOp );
+			break;
+		case ASM_MUL:
+			generateBinaryOperand( JUNO_MUL, curOp, binaryOp );
+			break;
+		case ASM_DIV:
+			generateBinaryOperand( JUNO_DIV, curOp, binaryOp );
+			break;
+		case ASM_MOD:
+			generateBinaryOperand( JUNO_MOD, curOp, binaryOp );
+			break;
+		case ASM_AND:
+			generateBinaryOperand( JUNO_AND, curOp, binaryOp );
+			break;
+		case ASM_OR:
+			generateBinaryOperand( JUNO_OR, curOp, binaryOp );
+			break;
+		case ASM_XOR:
+			generateBinaryOperand( JUNO_XOR, curOp, binaryOp );
+			break;
+		case ASM_NOT:
+			// Yes, this uses the binaryOp array but it sets unused fields to zero
+			generateUnaryOperand( JUNO_NOT, curOp, binaryOp );
+			break;
+//		case ASM_JUMP:
+//			generatePCRJump( JUNO_PCR_JUMP, curOp, binaryOp, static_cast<uint64_t>(i) );
+//			break;
+		case ASM_JZERO:
+			generatePCRRegJump( JUNO_PCR_JUMP_ZERO, curOp, binaryOp, static_cast<uint64_t>(i) );
+			break;
+		case ASM_JLTZ:
+			generatePCRRegJump( JUNO_PCR_JUMP_LTZ, curOp, binaryOp, static_cast<uint64_t>(i) );
+			break;
+		case ASM_JGTZ:
+			generatePCRRegJump( JUNO_PCR_JUMP_GTZ, curOp, binaryOp, static_cast<uint64_t>(i) );
+			break;
+		case ASM_LDA:
+			generateLoadAddr( JUNO_LOAD_ADDR, curOp, binaryOp );
+			break;
+		case ASM_STA:
+			generateLoadAddr( JUNO_STORE_ADDR, curOp, binaryOp );
+			break;
+		case ASM_LOAD:
+			generateLoad( JUNO_LOAD, curOp, binaryOp );
+			break;
+		case ASM_RAND:
+			generateRand( JUNO_RAND, curOp, binaryOp );
+			break;
+		case ASM_RSEED:
+			generateRandSeed(JUNO_RSEED, curOp, binaryOp );
+			break;
+		case ASM_STORE:
+			generateStore( JUNO_STORE, curOp, binaryOp );
+			break;
+		case ASM_VLOAD:
+			generateVector( JUNO_VLOAD, curOp, binaryOp );
+			break;
+		case ASM_VGATHER:
+			generateVector( JUNO_VGATHER, curOp, binaryOp );
+			break;
+		case ASM_VSTORE:
+			generateVector( JUNO_VSTORE, curOp, binaryOp );
+			break;
+		case ASM_HALT:
+			{
 				const uint8_t junoCode = JUNO_HALT;
 				const uint8_t zero     = 0;
 
@@ -227,29 +506,29 @@ public:
 				memcpy( (void*) &binaryOp[1], (void*)& zero, sizeof(zero) );
 				memcpy( (void*) &binaryOp[2], (void*)& zero, sizeof(zero) );
 				memcpy( (void*) &binaryOp[3], (void*)& zero, sizeof(zero) );
-			} else {
-				fprintf(stderr, "Unknown instruction code: %s at instruction index: %d\n",
-					curOp->getInstCode().c_str(), i);
-				exit(-1);
 			}
-
-			fwrite( &binaryOp[0], sizeof(char), 4, binary );
+			break;
+		default:
+			fprintf(stderr, "Unknown instruction code: %s at instruction index: %d\n",
+				curOp->getInstCode(), i);
+			exit(-1);
 		}
+
 	}
 
-	void generateRandSeed( const uint8_t junoCode, AssemblyOperation* curOp, char* binaryOp ) {
+	void generateRandSeed( const uint8_t junoCode, const AssemblyOperation* curOp, char* binaryOp ) {
 		if( curOp->countOperands() != 1 ) {
 			fprintf(stderr, "Error: rseed-instruction must one operand\n");
 			exit(-1);
 		}
 
-		if( curOp->getOperand(0)->getType() != REGISTER_OPERAND ) {
+		if( curOp->getOperand(0).getType() != REGISTER_OPERAND ) {
 			fprintf(stderr, "Error: rseed-instruction can only have register operands.\n");
 			exit(-1);
 		}
 
-		AssemblyRegisterOperand* regOpOne = dynamic_cast<AssemblyRegisterOperand*>( curOp->getOperand(0) );
-		const uint8_t regOne = regOpOne->getRegister();
+		const AssemblyOperand& regOpOne = curOp->getOperand(0);
+		const uint8_t regOne = regOpOne.getRegister();
 
 		const uint64_t regOne64 = static_cast<uint64_t>(regOne);
 
@@ -257,19 +536,19 @@ public:
 		memcpy( (void*) &binaryOp[0], (void*) &finalInst, sizeof(finalInst) );
 	}
 
-	void generateRand( const uint8_t junoCode, AssemblyOperation* curOp, char* binaryOp ) {
+	void generateRand( const uint8_t junoCode, const AssemblyOperation* curOp, char* binaryOp ) {
 		if( curOp->countOperands() != 1 ) {
 			fprintf(stderr, "Error: rand-instruction must one operand\n");
 			exit(-1);
 		}
 
-		if( curOp->getOperand(0)->getType() != REGISTER_OPERAND ) {
+		if( curOp->getOperand(0).getType() != REGISTER_OPERAND ) {
 			fprintf(stderr, "Error: rand-instruction can only have register operands.\n");
 			exit(-1);
 		}
 
-		AssemblyRegisterOperand* regOpOne = dynamic_cast<AssemblyRegisterOperand*>( curOp->getOperand(0) );
-		const uint8_t regOne = regOpOne->getRegister();
+		const AssemblyOperand& regOpOne = curOp->getOperand(0);
+		const uint8_t regOne = regOpOne.getRegister();
 
 		const uint64_t regOne64 = static_cast<uint64_t>(regOne);
 
@@ -277,48 +556,50 @@ public:
 		memcpy( (void*) &binaryOp[0], (void*) &finalInst, sizeof(finalInst) );
 	}
 
-	void generateLoad( const uint8_t junoCode, AssemblyOperation* curOp, char* binaryOp ) {
+	void generateLoad( const uint8_t junoCode, const AssemblyOperation* curOp, char* binaryOp ) {
 		if( curOp->countOperands() != 2 ) {
-			fprintf(stderr, "Error: load-instruction %s must have two operands.\n", curOp->getInstCode().c_str());
+			fprintf(stderr, "Error: load-instruction %s must have two operands.\n", curOp->getInstCode());
 			exit(-1);
 		}
 
-		if( curOp->getOperand(0)->getType() != REGISTER_OPERAND && curOp->getOperand(1)->getType() != REGISTER_OPERAND ) {
+		if( curOp->getOperand(0).getType() != REGISTER_OPERAND || curOp->getOperand(1).getType() != REGISTER_OPERAND ) {
 			fprintf(stderr, "Error: load-instruction can only have register operands and at least one is non-register.\n");
 			exit(-1);
 		}
 
-		AssemblyRegisterOperand* regOpOne = dynamic_cast<AssemblyRegisterOperand*>( curOp->getOperand(0) );
-		AssemblyRegisterOperand* regOpTwo = dynamic_cast<AssemblyRegisterOperand*>( curOp->getOperand(1) );
+		const AssemblyOperand& regOpOne = curOp->getOperand(0);
+		const AssemblyOperand& regOpTwo = curOp->getOperand(1);
 
-		const uint8_t regOne = regOpOne->getRegister();
-		const uint8_t regTwo = regOpTwo->getRegister();
+		const uint8_t regOne = regOpOne.getRegister();
+		const uint8_t regTwo = regOpTwo.getRegister();
 
 		const uint64_t regOne64 = static_cast<uint64_t>(regOne);
 		const uint64_t regTwo64 = static_cast<uint64_t>(regTwo);
 
-		printf("Creating a LOAD reg1=r%" PRIu8 ", regTarget=r%" PRIu8 "\n", regOne, regTwo);
+		if( verbose ) {
+			printf("Creating a LOAD reg1=r%" PRIu8 ", regTarget=r%" PRIu8 "\n", regOne, regTwo);
+		}
 
 		uint32_t finalInst = static_cast<uint32_t>(junoCode) + (regTwo64 << 24) + (regOne64 << 8);
                 memcpy( (void*) &binaryOp[0], (void*) &finalInst, sizeof(finalInst) );
 	}
 
-	void generateStore( const uint8_t junoCode, AssemblyOperation* curOp, char* binaryOp ) {
+	void generateStore( const uint8_t junoCode, const AssemblyOperation* curOp, char* binaryOp ) {
 		if( curOp->countOperands() != 2 ) {
-			fprintf(stderr, "Error: store-instruction %s must have two operands.\n", curOp->getInstCode().c_str());
+			fprintf(stderr, "Error: store-instruction %s must have two operands.\n", curOp->getInstCode());
 			exit(-1);
 		}
 
-		if( curOp->getOperand(0)->getType() != REGISTER_OPERAND && curOp->getOperand(1)->getType() != REGISTER_OPERAND ) {
+		if( curOp->getOperand(0).getType() != REGISTER_OPERAND || curOp->getOperand(1).getType() != REGISTER_OPERAND ) {
 			fprintf(stderr, "Error: store-instruction can only have register operands and at least one is non-register.\n");
 			exit(-1);
 		}
 
-		AssemblyRegisterOperand* regOpOne = dynamic_cast<AssemblyRegisterOperand*>( curOp->getOperand(0) );
-		AssemblyRegisterOperand* regOpTwo = dynamic_cast<AssemblyRegisterOperand*>( curOp->getOperand(1) );
+		const AssemblyOperand& regOpOne = curOp->getOperand(0);
+		const AssemblyOperand& regOpTwo = curOp->getOperand(1);
 
-		const uint8_t regOne = regOpOne->getRegister();
-		const uint8_t regTwo = regOpTwo->getRegister();
+		const uint8_t regOne = regOpOne.getRegister();
+		const uint8_t regTwo = regOpTwo.getRegister();
 
 		const uint64_t regOne64 = static_cast<uint64_t>(regOne);
 		const uint64_t regTwo64 = static_cast<uint64_t>(regTwo);
@@ -327,38 +608,65 @@ public:
                 memcpy( (void*) &binaryOp[0], (void*) &finalInst, sizeof(finalInst) );
 	}
 
-	void generateLoadAddr(const uint8_t junoCode, AssemblyOperation* curOp, char* binaryOp ) {
+	// VLOAD/VSTORE/VGATHER rBase count rAddr, the count is a plain number and
+	// is encoded in the second register field
+	void generateVector( const uint8_t junoCode, const AssemblyOperation* curOp, char* binaryOp ) {
+		if( curOp->countOperands() != 3 ) {
+			fprintf(stderr, "Error: vector-instruction %s must have three operands.\n", curOp->getInstCode());
+			exit(-1);
+		}
+
+		if( curOp->getOperand(0).getType() != REGISTER_OPERAND || curOp->getOperand(1).getType() != MEMORY_OPERAND ||
+			curOp->getOperand(2).getType() != REGISTER_OPERAND ) {
+			fprintf(stderr, "Error: vector-instruction %s must have a register, a register count and a register as operands.\n",
+				curOp->getInstCode());
+			exit(-1);
+		}
+
+		const AssemblyOperand& regOpBase = curOp->getOperand(0);
+		const AssemblyOperand& countOp   = curOp->getOperand(1);
+		const AssemblyOperand& regOpAddr = curOp->getOperand(2);
+
+		const uint64_t count = countOp.getAddress();
+
+		if( count < 1 || count > JUNO_VECTOR_MAX_REGS ) {
+			fprintf(stderr, "Error: vector-instruction %s moves %" PRIu64 " registers, must be 1 to %d.\n",
+				curOp->getInstCode(), count, JUNO_VECTOR_MAX_REGS);
+			exit(-1);
+		}
+
+		const uint64_t regBase64 = static_cast<uint64_t>( regOpBase.getRegister() );
+		const uint64_t regAddr64 = static_cast<uint64_t>( regOpAddr.getRegister() );
+
+		uint32_t finalInst = static_cast<uint32_t>(junoCode) + (regBase64 << 24) + (count << 16) + (regAddr64 << 8);
+		memcpy( (void*) &binaryOp[0], (void*) &finalInst, sizeof(finalInst) );
+	}
+
+	void generateLoadAddr(const uint8_t junoCode, const AssemblyOperation* curOp, char* binaryOp ) {
 
 		if( curOp->countOperands() != 2 ) {
-                        fprintf(stderr, "Error: store-instruction %s must have two operands.\n", curOp->getInstCode().c_str());
+                        fprintf(stderr, "Error: store-instruction %s must have two operands.\n", curOp->getInstCode());
                         exit(-1);
                 }
 
-                if( curOp->getOperand(1)->getType() != REGISTER_OPERAND ) {
+                if( curOp->getOperand(1).getType() != REGISTER_OPERAND ) {
                         fprintf(stderr, "Error: load-instruction, second operand must be a register.\n");
                         exit(-1);
                 }
 
-                AssemblyRegisterOperand* regOp = dynamic_cast<AssemblyRegisterOperand*>(curOp->getOperand(1));
+                const AssemblyOperand& regOp = curOp->getOperand(1);
 
-                const uint8_t loadReg = regOp->getRegister();
+                const uint8_t loadReg = regOp.getRegister();
 
-                if( curOp->getOperand(0)->getType() != LITERAL_OPERAND ) {
+                if( curOp->getOperand(0).getType() != LITERAL_OPERAND && curOp->getOperand(0).getType() != DATA_ADDRESS_OPERAND ) {
                         fprintf(stderr, "Error: load-addr, first operand must be a literal.\n");
                         exit(-1);
                 }
 
-                AssemblyLiteralOperand* litOp = dynamic_cast<AssemblyLiteralOperand*>(curOp->getOperand(0));
-                uint64_t litVal  = static_cast<uint64_t>( litOp->getLiteral() );
+                const AssemblyOperand& litOp = curOp->getOperand(0);
+                uint64_t litVal  = static_cast<uint64_t>( litOp.getLiteral() );
 
-		int index = -1;
-
-		for( int i = 0; i < int64Literals.size(); ++i ) {
-			if(int64Literals[i] == litVal) {
-				index = i;
-				break;
-			}
-		}
+		const int index = findLiteral( litOp );
 
 		if( index == -1 ) {
 			fprintf(stderr, "Error: unable to find literal: %" PRId64 "\n", litVal);
@@ -372,37 +680,30 @@ public:
                 memcpy( (void*) &binaryOp[0], (void*) &finalInst, sizeof(finalInst) );
         }
 
-	void generateStoreAddr( const uint8_t junoCode, AssemblyOperation* curOp, char* binaryOp ) {
+	void generateStoreAddr( const uint8_t junoCode, const AssemblyOperation* curOp, char* binaryOp ) {
 		if( curOp->countOperands() != 2 ) {
-			fprintf(stderr, "Error: store-instruction %s must have two operands.\n", curOp->getInstCode().c_str());
+			fprintf(stderr, "Error: store-instruction %s must have two operands.\n", curOp->getInstCode());
 			exit(-1);
 		}
 
-		if( curOp->getOperand(0)->getType() != REGISTER_OPERAND ) {
+		if( curOp->getOperand(0).getType() != REGISTER_OPERAND ) {
 			fprintf(stderr, "Error: store-instruction, first operand must be a register.\n");
 			exit(-1);
 		}
 
-		AssemblyRegisterOperand* regOp = dynamic_cast<AssemblyRegisterOperand*>(curOp->getOperand(0));
+		const AssemblyOperand& regOp = curOp->getOperand(0);
 
-		const uint8_t storeReg = regOp->getRegister();
+		const uint8_t storeReg = regOp.getRegister();
 
-		if( curOp->getOperand(1)->getType() != LITERAL_OPERAND ) {
+		if( curOp->getOperand(1).getType() != LITERAL_OPERAND && curOp->getOperand(1).getType() != DATA_ADDRESS_OPERAND ) {
 			fprintf(stderr, "Error: store-addr, second operand must be a literal.\n");
 			exit(-1);
 		}
 
-		AssemblyLiteralOperand* litOp = dynamic_cast<AssemblyLiteralOperand*>(curOp->getOperand(1));
-                uint64_t litVal  = static_cast<uint64_t>( litOp->getLiteral() );
-
-		int index = -1;
+		const AssemblyOperand& litOp = curOp->getOperand(1);
+                uint64_t litVal  = static_cast<uint64_t>( litOp.getLiteral() );
 
-		for( int i = 0; i < int64Literals.size(); ++i ) {
-			if(int64Literals[i] == litVal) {
-				index = i;
-				break;
-			}
-		}
+		const int index = findLiteral( litOp );
 
 		if( index == -1 ) {
 			fprintf(stderr, "Error: unable to find literal: %" PRId64 "\n", litVal);
@@ -416,102 +717,105 @@ public:
 		memcpy( (void*) &binaryOp[0], (void*) &finalInst, sizeof(finalInst) );
 	}
 
-	void generatePCRJump( const uint8_t junoCode, AssemblyOperation* curOp, char* binaryOp, uint64_t instLoc ) {
+	void generatePCRJump( const uint8_t junoCode, const AssemblyOperation* curOp, char* binaryOp, uint64_t instLoc ) {
 		memcpy( (void*) &binaryOp[0], (void*) &junoCode, sizeof(junoCode) );
 
 		if( curOp->countOperands() != 1 ) {
-			fprintf(stderr, "Error: instruction %s can only have one operand (a LABEL)\n", curOp->getInstCode().c_str());
+			fprintf(stderr, "Error: instruction %s can only have one operand (a LABEL)\n", curOp->getInstCode());
 			exit(-1);
 		}
 
-		if( curOp->getOperand(0)->getType() != LABEL_OPERAND ) {
-			fprintf(stderr, "Error: instruction %s does not have a label operand.\n", curOp->getInstCode().c_str());
+		if( curOp->getOperand(0).getType() != LABEL_OPERAND ) {
+			fprintf(stderr, "Error: instruction %s does not have a label operand.\n", curOp->getInstCode());
 			exit(-1);
 		}
 
-		AssemblyLabelOperand* labelOp = dynamic_cast<AssemblyLabelOperand*>(curOp->getOperand(1));
+		const AssemblyOperand& labelOp = curOp->getOperand(0);
 
-		const int64_t labelLoc = static_cast<int64_t>( labelMap.find(labelOp->getLabel())->second );
+		const int64_t labelLoc = static_cast<int64_t>( labelLocs[ labelOp.getLabelId() ] );
 		const int64_t localDiff = static_cast<int64_t>(instLoc) - labelLoc;
 		const int16_t jumpBy16b = static_cast<int16_t>( localDiff );
 
 		memcpy( (void*) &binaryOp[2], (void*) &jumpBy16b, sizeof(jumpBy16b) );
 	}
 
-	void generatePCRRegJump( const uint8_t junoCode, AssemblyOperation* curOp, char* binaryOp, uint64_t instLoc ) {
+	void generatePCRRegJump( const uint8_t junoCode, const AssemblyOperation* curOp, char* binaryOp, uint64_t instLoc ) {
 		memcpy( (void*) &binaryOp[0], (void*) &junoCode, sizeof(junoCode) );
 
 		if( curOp->countOperands() != 2 ) {
 			fprintf(stderr, "Error: instruction (%s) must have two operands, it has %d\n",
-				curOp->getInstCode().c_str(), curOp->countOperands());
+				curOp->getInstCode(), curOp->countOperands());
 			exit(-1);
 		}
 
-		if( curOp->getOperand(0)->getType() != REGISTER_OPERAND ) {
+		if( curOp->getOperand(0).getType() != REGISTER_OPERAND ) {
 			fprintf(stderr, "Error: a performance-counter relative jump must provide a register to evaluate as its first operand.\n");
 			exit(-1);
 		}
 
-		AssemblyRegisterOperand* regOp = dynamic_cast<AssemblyRegisterOperand*>(curOp->getOperand(0));
-		const uint8_t reg = regOp->getRegister();
+		const AssemblyOperand& regOp = curOp->getOperand(0);
+		const uint8_t reg = regOp.getRegister();
 
 		memcpy( (void*) &binaryOp[1], (void*) &reg, sizeof(reg) );
 
-		if( curOp->getOperand(1)->getType() != LABEL_OPERAND ) {
+		if( curOp->getOperand(1).getType() != LABEL_OPERAND ) {
 			fprintf(stderr, "Error: a performance-counter relative jump must provide a label to jump to.\n");
+			exit(-1);
 		}
 
-		AssemblyLabelOperand* labelOp = dynamic_cast<AssemblyLabelOperand*>(curOp->getOperand(1));
+		const AssemblyOperand& labelOp = curOp->getOperand(1);
 
-		const int64_t jumpLoc = static_cast<int64_t>( labelMap.find(labelOp->getLabel())->second );
+		const int64_t jumpLoc = static_cast<int64_t>( labelLocs[ labelOp.getLabelId() ] );
 		const int64_t locDiff = jumpLoc - static_cast<int64_t>( instLoc );
 		const int16_t jumpBy16b = static_cast<int16_t>( locDiff );
 
-		printf("PCR-J-Class Generated with diff: %" PRId64 " -> (16b Encode) -> %" PRId16 "\n", locDiff, jumpBy16b);
+		if( verbose ) {
+			printf("PCR-J-Class Generated with diff: %" PRId64 " -> (16b Encode) -> %" PRId16 "\n", locDiff, jumpBy16b);
+		}
 
 		memcpy( (void*) &binaryOp[2], (void*) &jumpBy16b, sizeof(jumpBy16b) );
 	}
 
-	void generateBinaryOperand( const char junoCode, AssemblyOperation* curOp, char* binaryOp ) {
+	void generateBinaryOperand( const char junoCode, const AssemblyOperation* curOp, char* binaryOp ) {
 				memcpy( (void*) &binaryOp[0], (void*) &junoCode, sizeof(junoCode) );
 
 				if( curOp->countOperands() != 3 ) {
 					fprintf(stderr, "Error: instruction (%s) must have three operands, it only has %d\n",
-						curOp->getInstCode().c_str(), curOp->countOperands());
+						curOp->getInstCode(), curOp->countOperands());
 					exit(-1);
 				}
 
 				populateBinaryOperand( curOp, &binaryOp[1] );
 	}
 
-	void generateUnaryOperand( const char junoCode, AssemblyOperation* curOp, char* binaryOp ) {
+	void generateUnaryOperand( const char junoCode, const AssemblyOperation* curOp, char* binaryOp ) {
 				memcpy( (void*) &binaryOp[0], (void*) &junoCode, sizeof(junoCode) );
 
 				if( curOp->countOperands() != 2 ) {
 					fprintf(stderr, "Error: instruction (%s) must have two operands, it only has %d\n",
-						curOp->getInstCode().c_str(), curOp->countOperands());
+						curOp->getInstCode(), curOp->countOperands());
 					exit(-1);
 				}
 
 				populateUnaryOperand( curOp, &binaryOp[1] );
 	}
 
-	void populateUnaryOperand( AssemblyOperation* curOp, char* unaryOp ) {
+	void populateUnaryOperand( const AssemblyOperation* curOp, char* unaryOp ) {
 		// Zero out the entire operand array, unused fields need to be set to zero
 		for(int j = 0;j < 3; j++) {
 			unaryOp[j] = 0;
 		}
 
 		for( int j = 0; j < 2; ++j ) {
-                	AssemblyOperand* curOperand = curOp->getOperand(j);
+                	const AssemblyOperand& curOperand = curOp->getOperand(j);
 
-                                        if( curOperand->getType() != REGISTER_OPERAND ) {
+                                        if( curOperand.getType() != REGISTER_OPERAND ) {
                                                 fprintf(stderr, "Error: %s operation only allows register operands, operand %d is not a register.\n",
-                                                        curOp->getInstCode().c_str(), j);
+                                                        curOp->getInstCode(), j);
+                                                exit(-1);
                                         }
 
-                                        AssemblyRegisterOperand* curRegOperand = dynamic_cast<AssemblyRegisterOperand*>( curOperand );
-					const uint8_t reg = curRegOperand->getRegister();
+					const uint8_t reg = curOperand.getRegister();
 
 			if( j == 0 ) {
                                         memcpy( (void*) &unaryOp[j], (void*) &reg, sizeof(char) );
@@ -521,27 +825,95 @@ public:
                }
 	}
 
-	void populateBinaryOperand( AssemblyOperation* curOp, char* binaryOp ) {
+	void populateBinaryOperand( const AssemblyOperation* curOp, char* binaryOp ) {
 		for( int j = 0; j < 3; ++j ) {
-                	AssemblyOperand* curOperand = curOp->getOperand(j);
+                	const AssemblyOperand& curOperand = curOp->getOperand(j);
 
-                                        if( curOperand->getType() != REGISTER_OPERAND ) {
+                                        if( curOperand.getType() != REGISTER_OPERAND ) {
                                                 fprintf(stderr, "Error: %s operation only allows register operands, operand %d is not a register.\n",
-                                                        curOp->getInstCode().c_str(), j);
+                                                        curOp->getInstCode(), j);
+                                                exit(-1);
                                         }
 
-                                        AssemblyRegisterOperand* curRegOperand = dynamic_cast<AssemblyRegisterOperand*>( curOperand );
-					const uint8_t reg = curRegOperand->getRegister();
+					const uint8_t reg = curOperand.getRegister();
 
                                         memcpy( (void*) &binaryOp[j], (void*) &reg, sizeof(char) );
                                 }
 	}
 
 
+	void addSection( std::vector<AssemblySection>& sections, const uint32_t type, const uint64_t addr,
+		const uint64_t size, const void* payload ) {
+
+		AssemblySection newSection;
+		newSection.type       = type;
+		newSection.reserved   = 0;
+		newSection.addr       = addr;
+		newSection.fileOffset = 0;
+		newSection.size       = size;
+		newSection.payload    = payload;
+
+		sections.push_back( newSection );
+	}
+
+	// Count, then {addr, kind, name offset} entries sorted by address, then
+	// the NUL terminated names
+	void buildSymbolTable( const uint64_t textBase, const uint64_t dataBase, std::vector<char>& table ) {
+		std::vector< std::pair<uint64_t, uint32_t> > sorted;
+
+		for( size_t i = 0; i < labelLocs.size(); ++i ) {
+			const uint64_t addr = labelIsData[i] ? (dataBase + labelLocs[i]) : (textBase + (labelLocs[i] * 4));
+			sorted.push_back( std::pair<uint64_t, uint32_t>( addr, static_cast<uint32_t>(i) ) );
+		}
+
+		std::sort( sorted.begin(), sorted.end() );
+
+		const uint64_t count = static_cast<uint64_t>( sorted.size() );
+		const size_t namesStart = 8 + (sorted.size() * 16);
+		table.resize( namesStart );
+		memcpy( &table[0], &count, sizeof(count) );
+
+		for( size_t i = 0; i < sorted.size(); ++i ) {
+			const uint32_t labelId    = sorted[i].second;
+			const uint32_t kind       = labelIsData[labelId] ? JUNO_ASM_SYMBOL_DATA : JUNO_ASM_SYMBOL_CODE;
+			const uint32_t nameOffset = static_cast<uint32_t>( table.size() - namesStart );
+
+			memcpy( &table[8 + (i * 16)], &sorted[i].first, sizeof(uint64_t) );
+			memcpy( &table[8 + (i * 16) + 8], &kind, sizeof(kind) );
+			memcpy( &table[8 + (i * 16) + 12], &nameOffset, sizeof(nameOffset) );
+
+			table.insert( table.end(), labelNames[labelId].begin(), labelNames[labelId].end() );
+			table.push_back( '\0' );
+		}
+	}
+
+	// Count, then the source line of each instruction in text order
+	void buildLineTable( std::vector<char>& table ) {
+		const uint64_t count = static_cast<uint64_t>( op.size() );
+		table.resize( 8 + (op.size() * 4) );
+		memcpy( &table[0], &count, sizeof(count) );
+
+		for( size_t i = 0; i < op.size(); ++i ) {
+			const uint32_t line = op[i].getLine();
+			memcpy( &table[8 + (i * 4)], &line, sizeof(line) );
+		}
+	}
+
+
 protected:
-	std::map<std::string, uint64_t> labelMap;
+	const bool verbose;
+	std::unordered_map<std::string, uint32_t> labelIds;
+	std::vector<std::string> labelNames;
+	std::vector<uint64_t> labelLocs;
+	std::vector<bool> labelIsData;
 	std::vector<int64_t> int64Literals;
-	std::vector<AssemblyOperation*>* op;
+	std::unordered_map<int64_t, int> literalIndex;
+	std::unordered_map<uint32_t, int> dataAddressIndex;
+	std::vector<int64_t> dataWords;
+	std::vector<AssemblyDataExtent> dataExtents;
+	uint64_t dataSpanWords;
+	uint64_t bssWords;
+	std::vector<AssemblyOperation> op;
 
 };
 
@@ -18,6 +18,13 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <random>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "asmop.h"
 #include "asmreader.h"
@@ -26,9 +33,11 @@
 using namespace SST::Juno::Assembler;
 
 AssemblyReader::AssemblyReader( AssemblerOptions* ops ) :
-	options( ops ) {}
+	options( ops ), source( NULL ), sourceLen( 0 ), sourceMapped( false ), dataSection( false ) {}
 
-AssemblyReader::~AssemblyReader() {}
+AssemblyReader::~AssemblyReader() {
+	closeSource();
+}
 
 int64_t AssemblyReader::convertLiteralFromString(const char* litStr) {
 	if( strlen(litStr) < 2 ) {
@@ -44,112 +53,376 @@ int64_t AssemblyReader::convertLiteralFromString(const char* litStr) {
 	return std::atoll( &litStr[1] );
 }
 
-bool AssemblyReader::readLine(char* buffer, const int buffLen) {
+// Same result as atoll on the text, which is not null terminated
+static int64_t convertDecimal( const char* numStart, const char* numEnd ) {
+	bool negative = false;
+	uint64_t value = 0;
+
+	if( numStart < numEnd && ('-' == *numStart || '+' == *numStart) ) {
+		negative = ('-' == *numStart);
+		numStart++;
+	}
+
+	for( ; numStart < numEnd && isdigit( *numStart ); numStart++ ) {
+		value = (value * 10) + static_cast<uint64_t>( *numStart - '0' );
+	}
+
+	return negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+}
+
+// Maps a regular input file so lines are parsed in place, anything else
+// (stdin, a pipe) is read into a buffer first
+void AssemblyReader::openSource() {
 	FILE* inFile = options->getInputFile();
 
-	if( feof( inFile ) ) {
-		return false;
+	if( NULL == inFile ) {
+		fprintf(stderr, "Error: unable to open the input file.\n");
+		exit(-1);
+	}
+
+	struct stat inStat;
+
+	if( 0 == fstat( fileno(inFile), &inStat ) && S_ISREG(inStat.st_mode) && inStat.st_size > 0 ) {
+		void* mapped = mmap( NULL, static_cast<size_t>(inStat.st_size), PROT_READ, MAP_PRIVATE, fileno(inFile), 0 );
+
+		if( MAP_FAILED != mapped ) {
+			madvise( mapped, static_cast<size_t>(inStat.st_size), MADV_SEQUENTIAL );
+
+			source       = static_cast<const char*>( mapped );
+			sourceLen    = static_cast<size_t>( inStat.st_size );
+			sourceMapped = true;
+			return;
+		}
+	}
+
+	char readBuffer[65536];
+	size_t readLen = 0;
+
+	while( (readLen = fread( readBuffer, sizeof(char), sizeof(readBuffer), inFile )) > 0 ) {
+		sourceCopy.insert( sourceCopy.end(), readBuffer, readBuffer + readLen );
+	}
+
+	source    = sourceCopy.data();
+	sourceLen = sourceCopy.size();
+}
+
+void AssemblyReader::closeSource() {
+	if( sourceMapped ) {
+		munmap( const_cast<char*>(source), sourceLen );
+	}
+
+	sourceCopy.clear();
+	source       = NULL;
+	sourceLen    = 0;
+	sourceMapped = false;
+}
+
+AssemblyOperand AssemblyReader::parseOperand( AssemblyProgram* program, const char* tokStart, const char* tokEnd,
+	const uint32_t lineNo ) {
+
+	const int tokLen  = static_cast<int>( tokEnd - tokStart );
+	const bool verbose = options->isVerbose();
+
+	if( tokStart[0] == 'r' || tokStart[0] == 'R' ) {
+		if( tokLen > JUNO_MAX_REGISTER_DIGITS || tokLen == 1 ) {
+			fprintf(stderr, "Error: register number (%.*s) is badly formed on line %" PRIu32 ".\n",
+				tokLen, tokStart, lineNo);
+			exit(-1);
+		}
+
+		const uint8_t reg = static_cast<uint8_t>( convertDecimal( tokStart + 1, tokEnd ) );
+
+		if( verbose ) {
+			printf("Making a register from: %.*s\n", tokLen, tokStart);
+			printf("Register: %" PRIu8 "\n", reg);
+		}
+
+		return AssemblyOperand( REGISTER_OPERAND, reg );
+	} else if( tokStart[0] == '$' ) {
+		if( tokLen == 1 ) {
+			fprintf(stderr, "Error: literal value is not long enough on line %" PRIu32 "!\n", lineNo);
+			exit(-1);
+		}
+
+		// $NAME is the address of a data label
+		if( ! isdigit( tokStart[1] ) && '-' != tokStart[1] && '+' != tokStart[1] ) {
+			if( verbose ) {
+				printf("Making a data address from: %.*s\n", tokLen, tokStart);
+			}
+
+			return AssemblyOperand( DATA_ADDRESS_OPERAND, program->getLabelId( tokStart + 1, static_cast<size_t>(tokLen - 1) ) );
+		}
+
+		const int64_t literal = convertDecimal( tokStart + 1, tokEnd );
+
+		if( verbose ) {
+			printf("Making a literal from: %.*s\n", tokLen, tokStart);
+			printf("Literal: %" PRId64 "\n", literal);
+		}
+
+		return AssemblyOperand( LITERAL_OPERAND, literal );
+	} else if( isdigit( tokStart[0] ) ) {
+		if( verbose ) {
+			printf("Making a memory from: %.*s\n", tokLen, tokStart);
+		}
+
+		return AssemblyOperand( MEMORY_OPERAND, convertDecimal( tokStart, tokEnd ) );
 	} else {
-		int nextChar = fgetc( inFile );
-		int nextIndex = 0;
+		// Jump Label?
+		if( verbose ) {
+			printf("Making a jump label from %.*s\n", tokLen, tokStart);
+		}
+
+		return AssemblyOperand( LABEL_OPERAND, program->getLabelId( tokStart, static_cast<size_t>(tokLen) ) );
+	}
+}
+
+// Data directives, all values are 64-bit words:
+//   .data                    following lines fill the data segment
+//   .text                    following lines are instructions again
+//   .word v [v ...]          the listed values
+//   .fill count value        count copies of value
+//   .zero count              count zeros, kept out of the binary (BSS)
+//   .rand seed,count[,bound] count values from a mt19937_64 seeded with
+//                            seed, reduced modulo bound if one is given
+void AssemblyReader::parseDirective( AssemblyProgram* program, const char* tokStart, const char* tokEnd,
+	const char* lineEnd, const uint32_t lineNo ) {
+
+	const std::string directive( tokStart, static_cast<size_t>(tokEnd - tokStart) );
+
+	directiveArgs.clear();
 
-		if( ('\n' == nextChar) || ('\r' == nextChar) || ('\f' == nextChar) ) {
+	while( true ) {
+		const char* argStart = tokEnd;
 
+		while( argStart < lineEnd && (' ' == *argStart || '\t' == *argStart || ',' == *argStart) ) {
+			argStart++;
+		}
+
+		if( argStart == lineEnd || '#' == *argStart ) {
+			break;
+		}
+
+		tokEnd = argStart;
+
+		while( tokEnd < lineEnd && ' ' != *tokEnd && '\t' != *tokEnd && ',' != *tokEnd ) {
+			tokEnd++;
+		}
+
+		const char* numStart = ('$' == *argStart) ? (argStart + 1) : argStart;
+		const char* digitStart = (numStart < tokEnd && ('-' == *numStart || '+' == *numStart)) ? (numStart + 1) : numStart;
+
+		if( digitStart == tokEnd || ! isdigit( *digitStart ) ) {
+			fprintf(stderr, "Error: %s on line %" PRIu32 " expects numbers, found \"%.*s\".\n",
+				directive.c_str(), lineNo, static_cast<int>(tokEnd - argStart), argStart);
+			exit(-1);
+		}
+
+		directiveArgs.push_back( convertDecimal( numStart, tokEnd ) );
+	}
+
+	if( ".data" == directive || ".text" == directive ) {
+		if( ! directiveArgs.empty() ) {
+			fprintf(stderr, "Error: %s on line %" PRIu32 " does not take values.\n", directive.c_str(), lineNo);
+			exit(-1);
+		}
+
+		dataSection = (".data" == directive);
+		return;
+	}
+
+	if( ! dataSection ) {
+		fprintf(stderr, "Error: %s on line %" PRIu32 " must follow a .data directive.\n", directive.c_str(), lineNo);
+		exit(-1);
+	}
+
+	const uint64_t startWords = program->countDataWords();
+
+	if( ".word" == directive ) {
+		if( directiveArgs.empty() ) {
+			fprintf(stderr, "Error: .word on line %" PRIu32 " needs at least one value.\n", lineNo);
+			exit(-1);
+		}
+
+		for( size_t i = 0; i < directiveArgs.size(); ++i ) {
+			program->addDataWord( directiveArgs[i] );
+		}
+	} else if( ".fill" == directive || ".zero" == directive || ".rand" == directive ) {
+		const size_t minArgs = (".zero" == directive) ? 1 : 2;
+		const size_t maxArgs = (".rand" == directive) ? 3 : minArgs;
+
+		if( directiveArgs.size() < minArgs || directiveArgs.size() > maxArgs ) {
+			fprintf(stderr, "Error: %s on line %" PRIu32 " takes %s.\n", directive.c_str(), lineNo,
+				(".zero" == directive) ? "a count" :
+				(".fill" == directive) ? "a count and a value" : "a seed, a count and an optional bound");
+			exit(-1);
+		}
+
+		const int64_t count = (".rand" == directive) ? directiveArgs[1] : directiveArgs[0];
+
+		if( count < 0 ) {
+			fprintf(stderr, "Error: %s on line %" PRIu32 " has a negative count.\n", directive.c_str(), lineNo);
+			exit(-1);
+		}
+
+		if( ".fill" == directive ) {
+			program->addDataWords( static_cast<uint64_t>(count), directiveArgs[1] );
+		} else if( ".zero" == directive ) {
+			program->addZeroWords( static_cast<uint64_t>(count) );
 		} else {
-			while( (EOF != nextChar) ) {
-				buffer[nextIndex] = (char) nextChar;
-				nextIndex++;
+			const uint64_t bound = (3 == directiveArgs.size()) ? static_cast<uint64_t>( directiveArgs[2] ) : 0;
+			std::mt19937_64 randGen( static_cast<uint64_t>( directiveArgs[0] ) );
+
+			for( int64_t i = 0; i < count; ++i ) {
+				const uint64_t nextRand = randGen();
+				program->addDataWord( static_cast<int64_t>( (0 == bound) ? nextRand : (nextRand % bound) ) );
+			}
+		}
+	} else {
+		fprintf(stderr, "Error: unknown directive %s on line %" PRIu32 ".\n", directive.c_str(), lineNo);
+		exit(-1);
+	}
 
-				nextChar = fgetc( inFile );
+	if( options->isVerbose() ) {
+		printf("Directive %s adds %" PRIu64 " words at data offset %" PRIu64 "\n", directive.c_str(),
+			program->countDataWords() - startWords, startWords * 8);
+	}
+}
+
+void AssemblyReader::parseLine( AssemblyProgram* program, const char* lineStart, const char* lineEnd,
+	const uint32_t lineNo ) {
 
-				if( ( '\n' == nextChar ) ||
-				    ( '\r' == nextChar ) ||
-				    ( '\f' == nextChar ) ) {
+	const bool verbose = options->isVerbose();
+
+	if( verbose ) {
+		printf("Line[%.*s]\n", static_cast<int>(lineEnd - lineStart), lineStart);
+	}
 
-					break;
-				}
+	const char* tokStart = lineStart;
+
+	while( tokStart < lineEnd && (' ' == *tokStart || '\t' == *tokStart) ) {
+		tokStart++;
+	}
+
+	// Blank lines and comments are ignored
+	if( tokStart == lineEnd || '#' == *tokStart ) {
+		return;
+	}
 
-				if( (nextIndex + 1) > buffLen ) {
-					fprintf(stderr, "Error: assembly warning - exceeded maximum line length\n");
-					break;
-				}
+	const char* tokEnd = tokStart;
+
+	while( tokEnd < lineEnd && ' ' != *tokEnd && '\t' != *tokEnd ) {
+		tokEnd++;
+	}
+
+	if( '.' == *tokStart ) {
+		parseDirective( program, tokStart, tokEnd, lineEnd, lineNo );
+		return;
+	}
+
+	if( ':' == *(tokEnd - 1) ) {
+		// This is an assembly label
+		if( dataSection ) {
+			if( verbose ) {
+				printf("Creating data label: \"%.*s\" at data offset: %" PRIu64 "...\n",
+					static_cast<int>(tokEnd - tokStart - 1), tokStart, program->countDataWords() * 8);
+			}
+
+			program->addDataLabel( tokStart, static_cast<size_t>(tokEnd - tokStart - 1) );
+		} else {
+			if( verbose ) {
+				printf("Creating label: \"%.*s\" at location: %" PRIu64 "...\n",
+					static_cast<int>(tokEnd - tokStart - 1), tokStart, program->countOperations());
 			}
+
+			program->addLabel( tokStart, static_cast<size_t>(tokEnd - tokStart - 1), program->countOperations() );
+		}
+
+		return;
+	}
+
+	if( dataSection ) {
+		fprintf(stderr, "Error: instruction on line %" PRIu32 " is in the .data section, add .text before it.\n", lineNo);
+		exit(-1);
+	}
+
+	const AssemblyMnemonic mnemonic = lookupMnemonic( tokStart, static_cast<size_t>(tokEnd - tokStart) );
+
+	if( ASM_UNKNOWN == mnemonic ) {
+		fprintf(stderr, "Error: unknown instruction code: %.*s on line %" PRIu32 "\n",
+			static_cast<int>(tokEnd - tokStart), tokStart, lineNo);
+		exit(-1);
+	}
+
+	if( verbose ) {
+		printf("Creating instruction [%s]...\n", asmMnemonicNames[mnemonic]);
+	}
+
+	AssemblyOperation newInst( mnemonic, lineNo );
+
+	while( true ) {
+		tokStart = tokEnd;
+
+		while( tokStart < lineEnd && (' ' == *tokStart || '\t' == *tokStart) ) {
+			tokStart++;
+		}
+
+		if( tokStart == lineEnd ) {
+			break;
 		}
 
-		buffer[nextIndex] = '\0';
+		tokEnd = tokStart;
+
+		while( tokEnd < lineEnd && ' ' != *tokEnd && '\t' != *tokEnd ) {
+			tokEnd++;
+		}
 
-		return (nextIndex > 0);
+		if( ! newInst.addOperand( parseOperand( program, tokStart, tokEnd, lineNo ) ) ) {
+			fprintf(stderr, "Error: instruction %s on line %" PRIu32 " has more than %d operands.\n",
+				newInst.getInstCode(), lineNo, JUNO_ASM_MAX_OPERANDS);
+			exit(-1);
+		}
 	}
+
+	program->addOperation( newInst );
 }
 
 AssemblyProgram* AssemblyReader::assemble() {
-	AssemblyProgram* program = new AssemblyProgram();
-
-	#define JUNO_MAX_LINE_LEN 2048
-
-	char* buffer = (char*) malloc( sizeof(char) * JUNO_MAX_LINE_LEN );
-	int currentLine = 1;
-
-	while( readLine(buffer, JUNO_MAX_LINE_LEN) ) {
-		printf("Line[%s]\n", buffer);
-
-		if( strlen(buffer) > 1 ) {
-			// Allow for comments, we ignore them
-			if( '#' != buffer[0] ) {
-				char* inst = strtok( buffer, " " );
-
-				if( inst[ strlen(inst) - 1 ] == ':' ) {
-					// This is an assembly label
-					inst[ strlen(inst) - 1 ] = '\0';
-
-					std::string label(inst);
-
-					printf("Creating label: \"%s\" at location: %" PRIu64 "...\n", label.c_str(), program->countOperations());
-					program->addLabel(label, program->countOperations());
-				} else {
-
-				printf("Creating instruction [%s]...\n", inst);
-
-				AssemblyOperation* newInst = new AssemblyOperation(inst);
-				program->addOperation(newInst);
-
-				printf("Populating operands...\n");
-
-				char* op = strtok(NULL, " ");
-				while( NULL != op ) {
-					if( op[0] == 'r' || op[0] == 'R' ) {
-						printf("Making a register from: %s\n", op);
-						newInst->addOperand( new AssemblyRegisterOperand( op ) );
-					} else if( op[0] == '$' ) {
-						// Literal?
-						printf("Making a literal from: %s\n", op);
-						//const int64_t literal = convertLiteralFromString(op);
-
-						AssemblyLiteralOperand* newLit = new AssemblyLiteralOperand( op );
-						newInst->addOperand( newLit );
-					} else if( isdigit( op[0] ) ) {
-						printf("Making a memory from: %s\n", op);
-						newInst->addOperand( new AssemblyMemoryOperand( op ) );
-						// Literal?
-					} else {
-						// Jump Label?
-						printf("Making a jump label from %s\n", op);
-						newInst->addOperand( new AssemblyLabelOperand( op ) );
-					}
-
-					op = strtok( NULL, " " );
-				}
-				}
-			}
+	AssemblyProgram* program = new AssemblyProgram( options->isVerbose() );
+
+	openSource();
+
+	const char* sourceEnd = source + sourceLen;
+	program->reserveOperations( static_cast<size_t>( std::count( source, sourceEnd, '\n' ) ) + 1 );
+
+	const char* lineStart = source;
+	uint32_t currentLine = 1;
+
+	while( lineStart < sourceEnd ) {
+		const char* lineEnd = lineStart;
+
+		while( lineEnd < sourceEnd && '\n' != *lineEnd && '\r' != *lineEnd && '\f' != *lineEnd ) {
+			lineEnd++;
+		}
+
+		// A single character cannot hold an instruction or a label
+		if( (lineEnd - lineStart) > 1 ) {
+			parseLine( program, lineStart, lineEnd, currentLine );
 		}
 
-		currentLine++;
+		if( lineEnd < sourceEnd && '\n' == *lineEnd ) {
+			currentLine++;
+		}
+
+		lineStart = lineEnd + 1;
 	}
 
-	free(buffer);
+	closeSource();
 
-	printf("Parsed all operations, found %d operations...\n",
-		static_cast<int>(program->countOperations()) );
+	if( options->isVerbose() ) {
+		printf("Parsed all operations, found %d operations...\n",
+			static_cast<int>(program->countOperations()) );
+	}
 
 	// Collect up all the literal values we have found in the program
 	// we want to have a unique set to decrease memory consumption
@@ -158,4 +431,3 @@ AssemblyProgram* AssemblyReader::assemble() {
 
 	return program;
 }
-
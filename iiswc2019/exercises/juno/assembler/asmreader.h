@@ -18,6 +18,8 @@
 #ifndef _H_SST_JUNO_ASM_READER_
 #define _H_SST_JUNO_ASM_READER_
 
+#include <vector>
+
 #include "asmop.h"
 #include "asmprogram.h"
 #include "asmoptions.h"
@@ -38,7 +40,22 @@ public:
 
 protected:
 	AssemblerOptions* options;
-	bool readLine(char* buffer, const int buffLen);
+
+	// The whole source, mapped from the input file or copied from a pipe
+	const char* source;
+	size_t sourceLen;
+	bool sourceMapped;
+	std::vector<char> sourceCopy;
+
+	// Lines after .data define the data segment, .text switches back
+	bool dataSection;
+	std::vector<int64_t> directiveArgs;
+
+	void openSource();
+	void closeSource();
+	void parseLine(AssemblyProgram* program, const char* lineStart, const char* lineEnd, const uint32_t lineNo);
+	void parseDirective(AssemblyProgram* program, const char* tokStart, const char* tokEnd, const char* lineEnd, const uint32_t lineNo);
+	AssemblyOperand parseOperand(AssemblyProgram* program, const char* tokStart, const char* tokEnd, const uint32_t lineNo);
 
 };
 
@@ -27,17 +27,93 @@
 namespace SST {
 namespace Juno {
 
+class JunoCustomInstructionHandler;
+
+// Implemented by the core which owns the handlers, told when a handler which
+// was waiting on an external response can take instructions again
+class JunoCustomInstructionOwner {
+
+public:
+	virtual ~JunoCustomInstructionOwner() {}
+	// released is true if the handler was holding issue until this completion
+	virtual void handlerComplete( JunoCustomInstructionHandler* handler, const bool released ) = 0;
+};
+
+// Handlers are never polled. From execute() a handler either reports how many
+// cycles it stays busy (busyFor) or starts a request which finishes when it
+// calls signalComplete() from an event handler, typically when a response
+// arrives on one of its links. busyUntilComplete() also holds issue until then,
+// startRequest() lets the core carry on while the request is outstanding, any
+// register the request writes must be marked pending in the register file.
+// A handler which does none of these is free on the next cycle.
 class JunoCustomInstructionHandler : public SST::SubComponent {
 
 public:
-	JunoCustomInstructionHandler( Component* owner, Params& params ) : SubComponent(owner) {}
+	JunoCustomInstructionHandler( Component* owner, Params& params ) : SubComponent(owner),
+		cpuOwner(NULL), cpuClockTC(NULL), busyCycles(0), outstanding(0), awaiting(false) {}
 	~JunoCustomInstructionHandler() {}
 
+	void attach( JunoCustomInstructionOwner* cpu, SST::TimeConverter* clockTC ) {
+		cpuOwner   = cpu;
+		cpuClockTC = clockTC;
+	}
+
+	// Cycles from issue until the next instruction may issue, read once by
+	// the core after each execute()
+	SST::Cycle_t takeBusyCycles() {
+		const SST::Cycle_t cycles = busyCycles;
+		busyCycles = 0;
+		return cycles;
+	}
+
+	bool awaitingCompletion() const { return awaiting; }
+	uint32_t requestsOutstanding() const { return outstanding; }
+
 	virtual bool canProcessInst( const uint8_t opCode ) = 0;
-	virtual int  execute( SST::Output* output, JunoCPUInstruction* inst,
+	// True if the op-code writes the register in the write field, the CPU
+	// then rejects r0/r1 and out of range registers there when the program
+	// is decoded. Register writes are not checked at run time so a handler
+	// must override this to return false for op-codes which write nothing.
+	virtual bool writesRegister( const uint8_t opCode ) { return true; }
+	virtual int  execute( SST::Output* output, const JunoCPUInstruction* inst,
 		JunoRegisterFile* regFile, JunoLoadStoreUnit* loadStoreUnit,
 		uint64_t* pc ) = 0;
-	virtual bool isBusy() = 0;
+
+protected:
+	void busyFor( const SST::Cycle_t cycles ) { busyCycles = cycles; }
+	void startRequest() { outstanding++; }
+
+	void busyUntilComplete() {
+		outstanding++;
+		awaiting = true;
+	}
+
+	void signalComplete() {
+		if( 0 == outstanding ) {
+			return;
+		}
+
+		const bool released = awaiting;
+
+		outstanding--;
+		awaiting = false;
+
+		if( NULL != cpuOwner ) {
+			cpuOwner->handlerComplete( this, released );
+		}
+	}
+
+	// Current cycle of the owning core's clock, for busy time statistics
+	SST::Cycle_t getCPUCycle() const {
+		return static_cast<SST::Cycle_t>( getCurrentSimTime( cpuClockTC ) );
+	}
+
+private:
+	JunoCustomInstructionOwner* cpuOwner;
+	SST::TimeConverter* cpuClockTC;
+	SST::Cycle_t busyCycles;
+	uint32_t outstanding;
+	bool awaiting;
 };
 
 }
@@ -0,0 +1,154 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_PHILOX
+#define _H_SST_JUNO_PHILOX
+
+#include <cinttypes>
+
+namespace SST {
+namespace Juno {
+
+// Blocks generated side by side in the bulk path
+#define JUNO_PHILOX_LANES 8
+
+// Counter based generator (Philox4x32-10). Number n of a stream is a pure
+// function of (seed, stream, n) so values do not depend on the order in
+// which they are asked for or on how the simulation is partitioned. Each
+// 128-bit block gives two 64-bit numbers, the counter is the block index
+// with the stream (the core ID) in the third word.
+class JunoPhiloxRNG {
+
+public:
+	JunoPhiloxRNG( const uint64_t seed ) {
+		setSeed( seed );
+	}
+
+	void setSeed( const uint64_t seed ) {
+		key0 = static_cast<uint32_t>( seed );
+		key1 = static_cast<uint32_t>( seed >> 32 );
+	}
+
+	int64_t generate( const uint32_t stream, const uint64_t index ) const {
+		uint32_t c0 = static_cast<uint32_t>( index >> 1 );
+		uint32_t c1 = static_cast<uint32_t>( index >> 33 );
+		uint32_t c2 = stream;
+		uint32_t c3 = 0;
+
+		block( c0, c1, c2, c3 );
+
+		return (0 == (index & 1)) ? combine( c0, c1 ) : combine( c2, c3 );
+	}
+
+	// Numbers first to first+count-1 of a stream, identical to calling
+	// generate() for each of them
+	void generate( const uint32_t stream, const uint64_t first, const uint32_t count, int64_t* out ) const {
+		uint64_t index = first;
+		uint32_t done  = 0;
+
+		// Start on a block boundary
+		if( done < count && 0 != (index & 1) ) {
+			out[done++] = generate( stream, index++ );
+		}
+
+		while( (count - done) >= (2 * JUNO_PHILOX_LANES) ) {
+			generateLanes( stream, index >> 1, &out[done] );
+
+			done  += 2 * JUNO_PHILOX_LANES;
+			index += 2 * JUNO_PHILOX_LANES;
+		}
+
+		while( done < count ) {
+			out[done++] = generate( stream, index++ );
+		}
+	}
+
+	// One Philox4x32-10 block, the counter words are replaced by the output
+	void block( uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3 ) const {
+		uint32_t k0 = key0;
+		uint32_t k1 = key1;
+
+		for( int round = 0; round < 10; ++round ) {
+			const uint64_t prod0 = static_cast<uint64_t>( JUNO_PHILOX_M0 ) * c0;
+			const uint64_t prod1 = static_cast<uint64_t>( JUNO_PHILOX_M1 ) * c2;
+
+			const uint32_t next0 = static_cast<uint32_t>( prod1 >> 32 ) ^ c1 ^ k0;
+			const uint32_t next2 = static_cast<uint32_t>( prod0 >> 32 ) ^ c3 ^ k1;
+
+			c1 = static_cast<uint32_t>( prod1 );
+			c3 = static_cast<uint32_t>( prod0 );
+			c0 = next0;
+			c2 = next2;
+
+			k0 += JUNO_PHILOX_W0;
+			k1 += JUNO_PHILOX_W1;
+		}
+	}
+
+protected:
+	// JUNO_PHILOX_LANES consecutive blocks, the rounds are unrolled inside
+	// the lane loop so the compiler vectorizes across lanes
+	void generateLanes( const uint32_t stream, const uint64_t firstBlock, int64_t* out ) const {
+		for( int lane = 0; lane < JUNO_PHILOX_LANES; ++lane ) {
+			const uint64_t blockIndex = firstBlock + lane;
+
+			uint32_t c0 = static_cast<uint32_t>( blockIndex );
+			uint32_t c1 = static_cast<uint32_t>( blockIndex >> 32 );
+			uint32_t c2 = stream;
+			uint32_t c3 = 0;
+			uint32_t k0 = key0;
+			uint32_t k1 = key1;
+
+			for( int round = 0; round < 10; ++round ) {
+				const uint64_t prod0 = static_cast<uint64_t>( JUNO_PHILOX_M0 ) * c0;
+				const uint64_t prod1 = static_cast<uint64_t>( JUNO_PHILOX_M1 ) * c2;
+
+				const uint32_t next0 = static_cast<uint32_t>( prod1 >> 32 ) ^ c1 ^ k0;
+				const uint32_t next2 = static_cast<uint32_t>( prod0 >> 32 ) ^ c3 ^ k1;
+
+				c1 = static_cast<uint32_t>( prod1 );
+				c3 = static_cast<uint32_t>( prod0 );
+				c0 = next0;
+				c2 = next2;
+
+				k0 += JUNO_PHILOX_W0;
+				k1 += JUNO_PHILOX_W1;
+			}
+
+			out[2 * lane]       = combine( c0, c1 );
+			out[(2 * lane) + 1] = combine( c2, c3 );
+		}
+	}
+
+	static const uint32_t JUNO_PHILOX_M0 = 0xD2511F53;
+	static const uint32_t JUNO_PHILOX_M1 = 0xCD9E8D57;
+	static const uint32_t JUNO_PHILOX_W0 = 0x9E3779B9;
+	static const uint32_t JUNO_PHILOX_W1 = 0xBB67AE85;
+
+	static int64_t combine( const uint32_t lo, const uint32_t hi ) {
+		return static_cast<int64_t>( (static_cast<uint64_t>( hi ) << 32) | lo );
+	}
+
+	uint32_t key0;
+	uint32_t key1;
+
+};
+
+}
+}
+
+#endif
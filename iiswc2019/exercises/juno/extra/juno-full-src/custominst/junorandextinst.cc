@@ -27,38 +27,57 @@ using namespace SST::RNG;
 using namespace SST::Juno;
 
 JunoExternalRandInstructionHandler::JunoExternalRandInstructionHandler( Component* owner, Params& params ) :
-		JunoCustomInstructionHandler( owner, params ), nextEvID(0), targetReg(0) {
+		JunoCustomInstructionHandler( owner, params ), nextEvID(0), nextSequence(0), cpuOut(NULL) {
+
+	coreID = params.find<uint32_t>("core-id", 0);
+	maxOutstanding = params.find<uint32_t>("max-outstanding", 1);
+
+	if( 0 == maxOutstanding ) {
+		maxOutstanding = 1;
+	}
+
+	prefetchDepth     = params.find<uint32_t>("prefetch-depth", 0);
+	prefetchBatch     = params.find<uint32_t>("prefetch-batch", 8);
+	prefetchLowWater  = params.find<uint32_t>("prefetch-low-water", prefetchBatch);
+	prefetchRequested = 0;
+
+	if( 0 == prefetchLowWater ) {
+		prefetchLowWater = 1;
+	}
+
+	if( prefetchDepth > 0 && (0 == prefetchBatch || prefetchBatch > prefetchDepth) ) {
+		SST::Output fatalOut("JunoExternalRandomHandler: ", 0, 0, Output::STDOUT);
+		fatalOut.fatal(CALL_INFO, -1, "Error: prefetch-batch (%" PRIu32 ") must be from 1 to prefetch-depth (%" PRIu32 ")\n",
+			prefetchBatch, prefetchDepth);
+	}
 
 	randAccLink = configureLink( "genlink", "1ns", new Event::Handler<JunoExternalRandInstructionHandler>(
 		this, &JunoExternalRandInstructionHandler::handleGenerateResp));
 
 	statRandCalls = registerStatistic<uint64_t>("rand-calls");
 	statCyclesBusy = registerStatistic<uint64_t>("cycles-busy");
+	statOutstanding = registerStatistic<uint64_t>("outstanding-rand");
+	statPrefetchHits = registerStatistic<uint64_t>("prefetch-hits");
+	statPrefetchRefills = registerStatistic<uint64_t>("prefetch-refills");
 }
 
 JunoExternalRandInstructionHandler::~JunoExternalRandInstructionHandler() {
 
 }
 
-bool JunoExternalRandInstructionHandler::isBusy() {
-	// Keep track of how many cycles we are busy
-	statCyclesBusy->addData(1);
-
-	// is the unit still processing old instructions?
-	// we detect this by seeing if we are targetting register zero
-	// since this is where the PC is located, if its zero
-	// we are not currently processing anything
-	return (targetReg > 0);
-}
-
 // Return true if the op-code is either RAND or RSEED instructions
 // that's all we can process in this unit
 bool JunoExternalRandInstructionHandler::canProcessInst( const uint8_t opCode ) {
 	return (opCode == JUNO_RAND) || (opCode == JUNO_RSEED);
 }
 
+// Only RAND writes a register, RSEED reads its seed
+bool JunoExternalRandInstructionHandler::writesRegister( const uint8_t opCode ) {
+	return (opCode == JUNO_RAND);
+}
+
 void JunoExternalRandInstructionHandler::handleGenerateResp(SST::Event* ev) {
-	cpuOut->verbose(CALL_INFO, 2, 0, "Recv response from random accelerator\n");
+	JUNO_VERBOSE(*cpuOut, 2, "Recv response from random accelerator\n");
 
 	JunoGenerateRandRespEvent* resp = dynamic_cast<JunoGenerateRandRespEvent*>(ev);
 
@@ -66,47 +85,147 @@ void JunoExternalRandInstructionHandler::handleGenerateResp(SST::Event* ev) {
 		cpuOut->fatal(CALL_INFO, -1, "Error: event was not a response from rand accelerator\n");
 	}
 
-	cpuOut->verbose(CALL_INFO, 2, 0, "Generated random value is: %" PRId64 "\n", resp->getRand());
-	registers->writeReg( targetReg, resp->getRand() );
+	auto reqItr = pending.find( resp->getID() );
+
+	if( reqItr == pending.end() ) {
+		cpuOut->fatal(CALL_INFO, -1, "Error: response from rand accelerator for unknown request %d\n",
+			resp->getID());
+	}
+
+	const JunoRandRequest req = reqItr->second;
+	pending.erase( reqItr );
 
-	// Reset the target register back to zero, this is our
-	// book keeping, if register is zero we are not currently
-	// processing any instructions
-	cpuOut->verbose(CALL_INFO, 2, 0, "Reseting register back to zero, free CPU to process instructions.\n");
-	targetReg = 0;
+	if( req.isRefill() ) {
+		handleRefill( resp );
+		delete ev;
+		return;
+	}
+
+	JUNO_VERBOSE(*cpuOut, 2, "Generated random value is: %" PRId64 " for request %d (r%" PRIu8 ")\n",
+		resp->getRand(), resp->getID(), req.targetReg);
+
+	// The CPU holds a RAND back while its target is pending so no other
+	// request is writing this register
+	req.registers->writeReg( req.targetReg, resp->getRand() );
+	req.registers->clearPending( req.targetReg );
 
-	// Keep a count of how many calls we make
+	// Keep a count of how many calls we make and how long each one took
 	statRandCalls->addData(1);
+	statCyclesBusy->addData( getCPUCycle() - req.issueCycle );
+
+	signalComplete();
 
 	// Delete the response now
 	delete ev;
 }
 
+void JunoExternalRandInstructionHandler::handleRefill( const JunoGenerateRandRespEvent* resp ) {
+	JUNO_VERBOSE(*cpuOut, 2, "Prefetch refill %d brought %" PRIu32 " numbers\n", resp->getID(), resp->getRandCount());
+
+	prefetchRequested -= resp->getRandCount();
+
+	for( uint32_t i = 0; i < resp->getRandCount(); ++i ) {
+		if( prefetchWaiting.empty() ) {
+			prefetchFIFO.push_back( resp->getRand(i) );
+			continue;
+		}
+
+		// Numbers go to waiting RANDs first so each RAND still receives
+		// the next number in sequence
+		const JunoRandRequest req = prefetchWaiting.front();
+		prefetchWaiting.pop_front();
+
+		req.registers->writeReg( req.targetReg, resp->getRand(i) );
+		req.registers->clearPending( req.targetReg );
+
+		statRandCalls->addData(1);
+		statCyclesBusy->addData( getCPUCycle() - req.issueCycle );
+
+		signalComplete();
+	}
+
+	refillPrefetch();
+}
+
+void JunoExternalRandInstructionHandler::refillPrefetch() {
+	while( (prefetchFIFO.size() + prefetchRequested) < prefetchLowWater &&
+		(prefetchFIFO.size() + prefetchRequested + prefetchBatch) <= prefetchDepth ) {
+
+		const int reqID = nextEvID++;
+		pending[reqID] = JunoRandRequest( NULL, 0, getCPUCycle(), prefetchBatch );
+		prefetchRequested += prefetchBatch;
+
+		JUNO_VERBOSE(*cpuOut, 2, "Requesting prefetch refill %d of %" PRIu32 " numbers\n", reqID, prefetchBatch);
+		statPrefetchRefills->addData(1);
+
+		randAccLink->send( new JunoGenerateRandEvent( reqID, prefetchBatch, coreID, nextSequence ) );
+		nextSequence += prefetchBatch;
+	}
+}
+
 void JunoExternalRandInstructionHandler::executeRand( SST::Output* output, const JunoCPUInstruction* inst,
 	JunoRegisterFile* regFile ) {
 
-	targetReg = inst->getWriteReg();
-	output->verbose(CALL_INFO, 2, 0, "Executing custom RAND instruction: RAND[r%" PRIu8 "]\n", targetReg);
+	const uint8_t targetReg = inst->getWriteReg();
+	JUNO_VERBOSE(*output, 2, "Executing custom RAND instruction: RAND[r%" PRIu8 "]\n", targetReg);
 
-	registers = regFile;
 	cpuOut = output;
 
-	output->verbose(CALL_INFO, 2, 0, "Sending request to an external random number generator...\n");
+	if( prefetchDepth > 0 ) {
+		if( ! prefetchFIFO.empty() ) {
+			// Local dequeue, no round trip to the accelerator
+			regFile->writeReg( targetReg, prefetchFIFO.front() );
+			prefetchFIFO.pop_front();
+
+			statRandCalls->addData(1);
+			statPrefetchHits->addData(1);
+		} else {
+			JUNO_VERBOSE(*output, 2, "Prefetch FIFO empty, RAND waits for the next refill\n");
+
+			prefetchWaiting.push_back( JunoRandRequest( regFile, targetReg, getCPUCycle(), 1 ) );
+			regFile->setPending( targetReg );
+
+			if( prefetchWaiting.size() >= maxOutstanding ) {
+				busyUntilComplete();
+			} else {
+				startRequest();
+			}
+		}
+
+		refillPrefetch();
+		return;
+	}
+
+	JUNO_VERBOSE(*output, 2, "Sending request to an external random number generator...\n");
 
 	// Send a request to the accelerator to do some processing on our behalf
 	// this really generates a random number and sends it back to us
 	// to be written into the register file
-	JunoGenerateRandEvent* genRand = new JunoGenerateRandEvent(nextEvID++);
+	const int reqID = nextEvID++;
+	pending[reqID] = JunoRandRequest( regFile, targetReg, getCPUCycle(), 1 );
+	regFile->setPending( targetReg );
+
+	statOutstanding->addData( pending.size() );
+
+	JunoGenerateRandEvent* genRand = new JunoGenerateRandEvent(reqID, 1, coreID, nextSequence++);
 	randAccLink->send(genRand);
 
-	output->verbose(CALL_INFO, 2, 0, "Send to external generator complete.\n");
+	// Instructions reading the target wait on the register file, issue as a
+	// whole only stops once every request slot is in use
+	if( pending.size() >= maxOutstanding ) {
+		busyUntilComplete();
+	} else {
+		startRequest();
+	}
+
+	JUNO_VERBOSE(*output, 2, "Send to external generator complete.\n");
 }
 
 void JunoExternalRandInstructionHandler::executeRandSeed( SST::Output* output, const JunoCPUInstruction* inst,
         JunoRegisterFile* regFile ) {
 }
 
-int JunoExternalRandInstructionHandler::execute( SST::Output* output, JunoCPUInstruction* inst,
+int JunoExternalRandInstructionHandler::execute( SST::Output* output, const JunoCPUInstruction* inst,
         JunoRegisterFile* regFile, JunoLoadStoreUnit* loadStoreUnit, uint64_t* pc ) {
 
 	switch( inst->getInstCode() ) {
@@ -15,17 +15,20 @@
 
 
 
-#ifndef _H_SST_JUNO_RAND_UNIT
-#define _H_SST_JUNO_RAND_UNIT
+#ifndef _H_SST_JUNO_EXT_RAND_UNIT
+#define _H_SST_JUNO_EXT_RAND_UNIT
 
 #include <sst/core/link.h>
 #include <sst/core/elementinfo.h>
 #include <sst/core/subcomponent.h>
 #include <sst/core/rng/mersenne.h>
+#include <deque>
+#include <unordered_map>
 #include "custominst/junocustinst.h"
 
 #include "junoregfile.h"
 #include "junoldstunit.h"
+#include "custominst/randaccel/junogenrandresp.h"
 
 using namespace SST::RNG;
 
@@ -35,6 +38,24 @@ namespace Juno {
 #define JUNO_RAND	200
 #define JUNO_RSEED	201
 
+// A RAND waiting on the accelerator, keyed by the request event ID. A
+// prefetch refill has no target and asks for count numbers. The register
+// file is the issuing hardware thread's.
+class JunoRandRequest {
+
+public:
+	JunoRandRequest() : registers(NULL), targetReg(0), issueCycle(0), count(0) {}
+	JunoRandRequest( JunoRegisterFile* regFile, const uint8_t reg, const SST::Cycle_t cycle, const uint32_t numValues ) :
+		registers(regFile), targetReg(reg), issueCycle(cycle), count(numValues) {}
+
+	bool isRefill() const { return 0 == targetReg; }
+
+	JunoRegisterFile* registers;
+	uint8_t targetReg;
+	SST::Cycle_t issueCycle;
+	uint32_t count;
+};
+
 class JunoExternalRandInstructionHandler : public JunoCustomInstructionHandler {
 
 public:
@@ -44,15 +65,16 @@ public:
 	// Return true if the op-code is either RAND or RSEED instructions
 	// that's all we can process in this unit
 	bool canProcessInst( const uint8_t opCode );
+	bool writesRegister( const uint8_t opCode );
 	void executeRand( SST::Output* output, const JunoCPUInstruction* inst,
                 JunoRegisterFile* regFile );
 	void executeRandSeed( SST::Output* output, const JunoCPUInstruction* inst,
                 JunoRegisterFile* regFile );
-	int execute( SST::Output* output, JunoCPUInstruction* inst,
+	int execute( SST::Output* output, const JunoCPUInstruction* inst,
                 JunoRegisterFile* regFile, JunoLoadStoreUnit* loadStoreUnit,
 		uint64_t* pc );
-	bool isBusy();
 	void handleGenerateResp(SST::Event* ev);
+	void handleRefill( const JunoGenerateRandRespEvent* resp );
 
 	SST_ELI_REGISTER_SUBCOMPONENT(
 		JunoExternalRandInstructionHandler,
@@ -63,23 +85,53 @@ public:
 		"SST::Juno::CustomInstructionHandler"
 		)
 
+	SST_ELI_DOCUMENT_PARAMS(
+		{ "core-id", "Stream the accelerator generates this core's numbers from, give each core its own", "0" },
+		{ "max-outstanding", "RAND requests which may wait on the accelerator at once, later instructions only wait for the registers they use", "1" },
+		{ "prefetch-depth", "Random numbers held in a local FIFO which RAND takes from without a round trip, 0 sends every RAND to the accelerator", "0" },
+		{ "prefetch-batch", "Random numbers asked for by each FIFO refill", "8" },
+		{ "prefetch-low-water", "Refill once buffered plus requested numbers drop below this, defaults to prefetch-batch", "" }
+		)
+
 	SST_ELI_DOCUMENT_PORTS(
 		{ "genlink", "Link to the Random number accelerator", { "juno.JunoGenerateRandEvent", "" } }
 		)
 
 	SST_ELI_DOCUMENT_STATISTICS(
 		{ "rand-calls", "Calls to the RAND instruction", "calls", 1 },
-		{ "cycles-busy", "Cycles spent waiting for accelerator", "cycles", 1 }
+		{ "cycles-busy", "CPU cycles from each RAND issuing to its result arriving", "cycles", 1 },
+		{ "outstanding-rand", "RAND requests waiting on the accelerator (including itself) each time one is sent", "requests", 1 },
+		{ "prefetch-hits", "RAND instructions served from the prefetch FIFO", "calls", 1 },
+		{ "prefetch-refills", "Batched refill requests sent to the accelerator", "requests", 1 }
 		)
 
 private:
 	int nextEvID;
-	uint8_t targetReg;
-	JunoRegisterFile* registers;
+	// Requests carry this core's position in its number sequence so a
+	// counter based accelerator returns the same values whatever order
+	// requests are served in
+	uint32_t coreID;
+	uint64_t nextSequence;
+	uint32_t maxOutstanding;
+	std::unordered_map<int, JunoRandRequest> pending;
 	SST::Link* randAccLink;
 	SST::Output* cpuOut;
 	Statistic<uint64_t>* statRandCalls;
 	Statistic<uint64_t>* statCyclesBusy;
+	Statistic<uint64_t>* statOutstanding;
+	Statistic<uint64_t>* statPrefetchHits;
+	Statistic<uint64_t>* statPrefetchRefills;
+
+	void refillPrefetch();
+
+	// Prefetch mode, RANDs which found the FIFO empty wait in order for the
+	// next refill
+	uint32_t prefetchDepth;
+	uint32_t prefetchBatch;
+	uint32_t prefetchLowWater;
+	uint32_t prefetchRequested;
+	std::deque<int64_t> prefetchFIFO;
+	std::deque<JunoRandRequest> prefetchWaiting;
 
 };
 
@@ -30,22 +30,25 @@ JunoRandInstructionHandler::JunoRandInstructionHandler( Component* owner, Params
 	const uint64_t rngSeed = params.find<uint64_t>("seed", 101010101);
 	rng = new MersenneRNG( rngSeed );
 
+	const std::string rngType = params.find<std::string>("rng", "mersenne");
+	coreID       = params.find<uint32_t>("core-id", 0);
+	nextSequence = 0;
+	philox       = NULL;
+
+	if( "philox" == rngType ) {
+		philox = new JunoPhiloxRNG( rngSeed );
+	} else if( "mersenne" != rngType ) {
+		SST::Output fatalOut("JunoRandomHandler: ", 0, 0, Output::STDOUT);
+		fatalOut.fatal(CALL_INFO, -1, "Error: unknown rng type: %s, expected mersenne or philox\n", rngType.c_str());
+	}
+
 	statRandCalls = registerStatistic<uint64_t>("calls-to-rand");
 	statRandSeedCalls = registerStatistic<uint64_t>("calls-to-rseed");
-
-	cyclesLeft = 0;
 }
 
 JunoRandInstructionHandler::~JunoRandInstructionHandler() {
 	delete rng;
-}
-
-bool JunoRandInstructionHandler::isBusy() {
-	if( cyclesLeft > 0 ) {
-		cyclesLeft--;
-	}
-
-	return (cyclesLeft > 0);
+	delete philox;
 }
 
 // Return true if the op-code is either RAND or RSEED instructions
@@ -54,14 +57,20 @@ bool JunoRandInstructionHandler::canProcessInst( const uint8_t opCode ) {
 	return (opCode == JUNO_RAND) || (opCode == JUNO_RSEED);
 }
 
+// Only RAND writes a register, RSEED reads its seed
+bool JunoRandInstructionHandler::writesRegister( const uint8_t opCode ) {
+	return (opCode == JUNO_RAND);
+}
+
 void JunoRandInstructionHandler::executeRand( SST::Output* output, const JunoCPUInstruction* inst,
 	JunoRegisterFile* regFile ) {
 
 	const uint8_t resultReg = inst->getWriteReg();
 
-	output->verbose(CALL_INFO, 2, 0, "Executing custom RAND instruction: RAND[r%" PRIu8 "]\n", resultReg);
+	JUNO_VERBOSE(*output, 2, "Executing custom RAND instruction: RAND[r%" PRIu8 "]\n", resultReg);
 
-	const int64_t randVal = rng->generateNextInt64();
+	const int64_t randVal = (NULL == philox) ? rng->generateNextInt64() :
+		philox->generate( coreID, nextSequence++ );
 	regFile->writeReg( resultReg, randVal );
 }
 
@@ -70,26 +79,34 @@ void JunoRandInstructionHandler::executeRandSeed( SST::Output* output, const Jun
 
 	const uint8_t seedReg = inst->getReadReg1();
 
-	output->verbose(CALL_INFO, 2, 0, "Executing custom RSEED instruction: RSEED[r%" PRIu8 "]\n", seedReg);
+	JUNO_VERBOSE(*output, 2, "Executing custom RSEED instruction: RSEED[r%" PRIu8 "]\n", seedReg);
 
-	rng->seed( static_cast<uint64_t>( regFile->readReg( seedReg ) ) );
+	const uint64_t newSeed = static_cast<uint64_t>( regFile->readReg( seedReg ) );
+
+	if( NULL == philox ) {
+		rng->seed( newSeed );
+	} else {
+		// Reseeding starts the sequence again
+		philox->setSeed( newSeed );
+		nextSequence = 0;
+	}
 }
 
-int JunoRandInstructionHandler::execute( SST::Output* output, JunoCPUInstruction* inst,
+int JunoRandInstructionHandler::execute( SST::Output* output, const JunoCPUInstruction* inst,
         JunoRegisterFile* regFile, JunoLoadStoreUnit* loadStoreUnit, uint64_t* pc ) {
 
 	switch( inst->getInstCode() ) {
 	case JUNO_RAND:
 		executeRand( output, inst, regFile );
 		// Tell the owning CPU how many cycles this takes
-		cyclesLeft = 20;
+		busyFor( 20 );
 		statRandCalls->addData(1);
 		break;
 
 	case JUNO_RSEED:
 		executeRandSeed( output, inst, regFile );
 		// Tell the CPU how many cycles this instruction takes
-		cyclesLeft = 10;
+		busyFor( 10 );
 		statRandSeedCalls->addData(1);
 		break;
 
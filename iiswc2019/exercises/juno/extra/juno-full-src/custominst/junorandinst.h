@@ -22,6 +22,7 @@
 #include <sst/core/subcomponent.h>
 #include <sst/core/rng/mersenne.h>
 #include "custominst/junocustinst.h"
+#include "custominst/junophilox.h"
 
 #include "junoregfile.h"
 #include "junoldstunit.h"
@@ -43,14 +44,14 @@ public:
 	// Return true if the op-code is either RAND or RSEED instructions
 	// that's all we can process in this unit
 	bool canProcessInst( const uint8_t opCode );
+	bool writesRegister( const uint8_t opCode );
 	void executeRand( SST::Output* output, const JunoCPUInstruction* inst,
                 JunoRegisterFile* regFile );
 	void executeRandSeed( SST::Output* output, const JunoCPUInstruction* inst,
                 JunoRegisterFile* regFile );
-	int execute( SST::Output* output, JunoCPUInstruction* inst,
+	int execute( SST::Output* output, const JunoCPUInstruction* inst,
                 JunoRegisterFile* regFile, JunoLoadStoreUnit* loadStoreUnit,
 		uint64_t* pc );
-	bool isBusy();
 
 	SST_ELI_REGISTER_SUBCOMPONENT(
 		JunoRandInstructionHandler,
@@ -62,7 +63,9 @@ public:
 		)
 
 	SST_ELI_DOCUMENT_PARAMS(
-        	{ "seed", "Set the seed value for the random instructions", "101010101" }
+        	{ "seed", "Set the seed value for the random instructions", "101010101" },
+        	{ "rng", "Generator to use, mersenne or philox (numbers depend only on seed, core-id and how many RANDs came before)", "mersenne" },
+        	{ "core-id", "Stream philox generates this core's numbers from, give each core its own", "0" }
     		)
 
 	SST_ELI_DOCUMENT_STATISTICS(
@@ -72,9 +75,12 @@ public:
 
 private:
 	MersenneRNG* rng;
+	// Counter based generation, NULL when using the Mersenne Twister
+	JunoPhiloxRNG* philox;
+	uint32_t coreID;
+	uint64_t nextSequence;
 	Statistic<uint64_t>* statRandCalls;
 	Statistic<uint64_t>* statRandSeedCalls;
-	uint64_t cyclesLeft;
 
 };
 
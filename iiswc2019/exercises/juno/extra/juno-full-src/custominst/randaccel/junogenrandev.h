@@ -28,19 +28,35 @@ class JunoGenerateRandEvent : public SST::Event {
 public:
 	JunoGenerateRandEvent() : SST::Event() {}
 	JunoGenerateRandEvent( const int evID ):
-		SST::Event(), id(evID) {}
+		SST::Event(), id(evID), count(1), stream(0), sequence(0) {}
+	JunoGenerateRandEvent( const int evID, const uint32_t numValues ):
+		SST::Event(), id(evID), count(numValues), stream(0), sequence(0) {}
+	JunoGenerateRandEvent( const int evID, const uint32_t numValues, const uint32_t streamID, const uint64_t firstSeq ):
+		SST::Event(), id(evID), count(numValues), stream(streamID), sequence(firstSeq) {}
 	~JunoGenerateRandEvent() {}
 
 	int getID() const { return id; }
+	// Random numbers wanted, all are returned in a single response
+	uint32_t getCount() const { return count; }
+	// Core the numbers are for and the position of the first of them in
+	// that core's sequence, used by counter based generation
+	uint32_t getStream() const { return stream; }
+	uint64_t getSequence() const { return sequence; }
 
 	void serialize_order( SST::Core::Serialization::serializer &ser) override {
 		Event::serialize_order(ser);
 		ser & id;
+		ser & count;
+		ser & stream;
+		ser & sequence;
 	}
 
 	ImplementSerializable(SST::Juno::JunoGenerateRandEvent);
 protected:
 	int id;
+	uint32_t count;
+	uint32_t stream;
+	uint64_t sequence;
 };
 
 }
@@ -19,6 +19,7 @@
 #define _H_SST_JUNO_GEN_RAND_RESP_EVENT
 
 #include <sst/core/event.h>
+#include <vector>
 
 namespace SST {
 namespace Juno {
@@ -28,22 +29,26 @@ class JunoGenerateRandRespEvent : public SST::Event {
 public:
 	JunoGenerateRandRespEvent() : SST::Event() {}
 	JunoGenerateRandRespEvent( const int evID, const int64_t rand):
-		SST::Event(), id(evID), randNum(rand) {}
+		SST::Event(), id(evID), randNums(1, rand) {}
+	JunoGenerateRandRespEvent( const int evID, const std::vector<int64_t>& rands):
+		SST::Event(), id(evID), randNums(rands) {}
 	~JunoGenerateRandRespEvent() {}
 
 	int getID() const { return id; }
-	int64_t getRand() const { return randNum; }
+	int64_t getRand() const { return randNums[0]; }
+	int64_t getRand( const uint32_t index ) const { return randNums[index]; }
+	uint32_t getRandCount() const { return static_cast<uint32_t>( randNums.size() ); }
 
 	void serialize_order( SST::Core::Serialization::serializer &ser) override {
 		Event::serialize_order(ser);
 		ser & id;
-		ser & randNum;
+		ser & randNums;
 	}
 
 	ImplementSerializable(SST::Juno::JunoGenerateRandRespEvent);
 protected:
 	int id;
-	int64_t randNum;
+	std::vector<int64_t> randNums;
 };
 
 }
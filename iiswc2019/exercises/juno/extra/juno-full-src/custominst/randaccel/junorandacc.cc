@@ -17,8 +17,11 @@
 
 #include <sst/core/sst_config.h>
 
+#include <algorithm>
+
 #include "junorandacc.h"
 #include "junogenrandresp.h"
+#include "junoverbose.h"
 
 using namespace SST::Juno;
 
@@ -33,6 +36,16 @@ JunoRandAccelerator::JunoRandAccelerator(SST::ComponentId_t id, SST::Params& par
 	output->verbose(CALL_INFO, 1, 0, "Creating RNG with seed %" PRIu64 "...", rngSeed);
 	rng = new MersenneRNG( rngSeed );
 
+	const std::string rngType = params.find<std::string>("rng", "mersenne");
+	philox = NULL;
+
+	if( "philox" == rngType ) {
+		output->verbose(CALL_INFO, 1, 0, "Numbers are generated by core and sequence number (Philox4x32-10)\n");
+		philox = new JunoPhiloxRNG( rngSeed );
+	} else if( "mersenne" != rngType ) {
+		output->fatal(CALL_INFO, -1, "Error: unknown rng type: %s, expected mersenne or philox\n", rngType.c_str());
+	}
+
 	output->verbose(CALL_INFO, 1, 0, "Creating link to CPU...\n");
 	cpuLink = configureLink("cpulink", "1ns", new Event::Handler<JunoRandAccelerator>(
 			this, &JunoRandAccelerator::handleGenerateReq));
@@ -51,16 +64,52 @@ JunoRandAccelerator::JunoRandAccelerator(SST::ComponentId_t id, SST::Params& par
 		output->fatal(CALL_INFO, -1, "Error: unable to create self link for timing.\n");
 	}
 
+	const uint32_t pipelineDepth = params.find<uint32_t>("pipeline-depth", 1);
+	issueWidth    = params.find<uint32_t>("issue-width", 1);
+	queueCapacity = params.find<uint32_t>("queue-capacity", 16);
+
+	if( 0 == pipelineDepth || 0 == issueWidth ) {
+		output->fatal(CALL_INFO, -1, "Error: pipeline-depth and issue-width must be at least 1.\n");
+	}
+
+	// Every stage can hold a full issue group, with gentime spread over the
+	// stages this lets a new group start each cycle
+	maxInFlight     = pipelineDepth * issueWidth;
+	inFlight        = 0;
+	issuedThisCycle = 0;
+	lastIssueCycle  = 0;
+	busyStartCycle  = 0;
+
+	output->verbose(CALL_INFO, 1, 0, "Pipeline of %" PRIu32 " stages, %" PRIu32 " requests issued per cycle, %" PRIu32 " may queue\n",
+		pipelineDepth, issueWidth, queueCapacity);
+
+	std::string accClock = params.find<std::string>("clock", "1GHz");
+	accClockHandler = new SST::Clock::Handler<JunoRandAccelerator>(this, &JunoRandAccelerator::clockTick);
+	accClockTC      = registerClock(accClock, accClockHandler);
+
+	// Nothing is queued yet, the first tick switches the clock off
+	clockRunning = true;
+
+	statQueueOccupancy    = registerStatistic<uint64_t>("queue-occupancy");
+	statPipelineOccupancy = registerStatistic<uint64_t>("pipeline-occupancy");
+	statBusyCycles        = registerStatistic<uint64_t>("busy-cycles");
+	statBatchSize         = registerStatistic<uint64_t>("batch-size");
+
 	output->verbose(CALL_INFO, 1, 0, "Ready to use.\n");
 }
 
 JunoRandAccelerator::~JunoRandAccelerator() {
+	for( size_t i = 0; i < waitQueue.size(); ++i ) {
+		delete waitQueue[i];
+	}
+
 	delete rng;
+	delete philox;
 	delete output;
 }
 
 void JunoRandAccelerator::handleGenerateReq(SST::Event* ev) {
-	output->verbose(CALL_INFO, 4, 0, "Received request to generate a random number.\n");
+	JUNO_VERBOSE(*output, 4, "Received request to generate a random number.\n");
 
 	JunoGenerateRandEvent* genEv = dynamic_cast<JunoGenerateRandEvent*>(ev);
 
@@ -68,15 +117,82 @@ void JunoRandAccelerator::handleGenerateReq(SST::Event* ev) {
 		output->fatal(CALL_INFO, -1, "Error: unable to convert event from CPU\n");
 	}
 
-	output->verbose(CALL_INFO, 4, 0, "Request ID=%d\n", genEv->getID());
+	const uint32_t count = std::max( genEv->getCount(), static_cast<uint32_t>(1) );
+
+	JUNO_VERBOSE(*output, 4, "Request ID=%d for %" PRIu32 " numbers\n", genEv->getID(), count);
+
+	statQueueOccupancy->addData( waitQueue.size() );
+	statBatchSize->addData( count );
+
+	batches[ genEv->getID() ] = JunoRandBatch( count, genEv->getStream(), genEv->getSequence() );
 
-	// Pass the event on in the self timing link, this will return when
-	// the event gets generated
-	selfGenerateLink->send( genEv );
+	// Requests enter the pipeline in arrival order
+	if( waitQueue.empty() && tryIssue( genEv ) ) {
+		delete genEv;
+		return;
+	}
+
+	if( waitQueue.size() >= queueCapacity ) {
+		output->fatal(CALL_INFO, -1, "Error: request queue is full (%" PRIu32 " requests), raise queue-capacity or lower the CPU handler's max-outstanding\n",
+			queueCapacity);
+	}
+
+	waitQueue.push_back( genEv );
+
+	if( ! clockRunning ) {
+		reregisterClock( accClockTC, accClockHandler );
+		clockRunning = true;
+	}
+}
+
+bool JunoRandAccelerator::tryIssue( JunoGenerateRandEvent* genEv ) {
+	const SST::Cycle_t now = static_cast<SST::Cycle_t>( getCurrentSimTime( accClockTC ) );
+
+	if( now != lastIssueCycle ) {
+		lastIssueCycle  = now;
+		issuedThisCycle = 0;
+	}
+
+	JunoRandBatch& batch = batches[ genEv->getID() ];
+
+	while( batch.issued < batch.count ) {
+		if( inFlight >= maxInFlight || issuedThisCycle >= issueWidth ) {
+			return false;
+		}
+
+		if( 0 == inFlight ) {
+			busyStartCycle = now;
+		}
+
+		inFlight++;
+		issuedThisCycle++;
+		batch.issued++;
+		statPipelineOccupancy->addData( inFlight );
+
+		// Pass each number on in the self timing link, this will return
+		// when the number gets generated
+		selfGenerateLink->send( new JunoGenerateRandEvent( genEv->getID() ) );
+	}
+
+	return true;
+}
+
+bool JunoRandAccelerator::clockTick( SST::Cycle_t currentCycle ) {
+	while( ! waitQueue.empty() && tryIssue( waitQueue.front() ) ) {
+		delete waitQueue.front();
+		waitQueue.pop_front();
+	}
+
+	if( waitQueue.empty() ) {
+		clockRunning = false;
+		return true;
+	}
+
+	return false;
 }
 
 void JunoRandAccelerator::handleRNGenerated(SST::Event* ev) {
-	output->verbose(CALL_INFO, 4, 0, "Generated a random number, ready to return response.\n");
+	JUNO_VERBOSE(*output, 4, "Generated a random number, ready to return response.\n");
 
 	JunoGenerateRandEvent* genEv = dynamic_cast<JunoGenerateRandEvent*>(ev);
 
@@ -84,14 +200,43 @@ void JunoRandAccelerator::handleRNGenerated(SST::Event* ev) {
 		output->fatal(CALL_INFO, -1, "Error: unable to convert event from CPU\n");
 	}
 
-	JunoGenerateRandRespEvent* resp = new JunoGenerateRandRespEvent(genEv->getID(),
-		rng->generateNextInt64());
+	inFlight--;
+
+	if( 0 == inFlight ) {
+		statBusyCycles->addData( static_cast<SST::Cycle_t>( getCurrentSimTime( accClockTC ) ) - busyStartCycle );
+	}
+
+	auto batchItr = batches.find( genEv->getID() );
+
+	if( batchItr == batches.end() ) {
+		output->fatal(CALL_INFO, -1, "Error: generated a number for unknown request %d\n", genEv->getID());
+	}
+
+	JunoRandBatch& batch = batchItr->second;
+	batch.generated++;
+
+	if( NULL == philox ) {
+		batch.values.push_back( rng->generateNextInt64() );
+
+		JUNO_VERBOSE(*output, 4, "Request ID=%d, is given a random number: %" PRId64 " (%" PRIu32 " of %" PRIu32 ")\n",
+			genEv->getID(), batch.values.back(), batch.generated, batch.count);
+	}
+
+	// Send back to the CPU once the whole request is generated
+	if( batch.generated == batch.count ) {
+		if( NULL != philox ) {
+			// Values depend only on the stream position, the whole batch
+			// is produced at once on the bulk path
+			batch.values.resize( batch.count );
+			philox->generate( batch.stream, batch.sequence, batch.count, &batch.values[0] );
 
-	output->verbose(CALL_INFO, 4, 0, "Request ID=%d, is given a random number: %" PRId64 "\n",
-		resp->getID(), resp->getRand());
+			JUNO_VERBOSE(*output, 4, "Request ID=%d, is given %" PRIu32 " numbers from core %" PRIu32 " sequence %" PRIu64 "\n",
+				genEv->getID(), batch.count, batch.stream, batch.sequence);
+		}
 
-	// Send back to the CPU
-	cpuLink->send(resp);
+		cpuLink->send( new JunoGenerateRandRespEvent( genEv->getID(), batch.values ) );
+		batches.erase( batchItr );
+	}
 
 	// We can not delete the request, free up memory
 	if( NULL != ev) {
@@ -22,8 +22,12 @@
 #include <sst/core/component.h>
 #include <sst/core/elementinfo.h>
 #include <sst/core/rng/mersenne.h>
+#include <deque>
+#include <unordered_map>
+#include <vector>
 
 #include "junogenrandev.h"
+#include "custominst/junophilox.h"
 
 using namespace SST::RNG;
 using namespace SST::Core;
@@ -31,6 +35,24 @@ using namespace SST::Core;
 namespace SST {
 namespace Juno {
 
+// Values generated so far for one request, a request for several numbers
+// takes one pipeline slot per number and is answered once all are done
+class JunoRandBatch {
+public:
+	JunoRandBatch() : count(0), issued(0), generated(0), stream(0), sequence(0) {}
+	JunoRandBatch( const uint32_t numValues, const uint32_t streamID, const uint64_t firstSeq ) :
+		count(numValues), issued(0), generated(0), stream(streamID), sequence(firstSeq) {
+		values.reserve( numValues );
+	}
+
+	uint32_t count;
+	uint32_t issued;
+	uint32_t generated;
+	uint32_t stream;
+	uint64_t sequence;
+	std::vector<int64_t> values;
+};
+
 class JunoRandAccelerator : public SST::Component {
 public:
 	JunoRandAccelerator(SST::ComponentId_t id, SST::Params& params);
@@ -38,6 +60,7 @@ public:
 
 	void handleGenerateReq(SST::Event* ev);
 	void handleRNGenerated(SST::Event* ev);
+	bool clockTick( SST::Cycle_t currentCycle );
 
 	SST_ELI_REGISTER_COMPONENT(
 		JunoRandAccelerator,
@@ -50,18 +73,55 @@ public:
 
 	SST_ELI_DOCUMENT_PARAMS(
 		{ "seed", "Random number generator seed", "1010101" },
+		{ "rng", "Generator to use, mersenne draws numbers in the order they finish, philox derives each from the requesting core and its sequence number so results do not depend on timing or partitioning", "mersenne" },
 		{ "verbose", "Sets the level of verbosity for the output", "0" },
-		{ "gentime", "Sets the generate time for the accelerator", "10ns" }
+		{ "gentime", "Sets the generate time for the accelerator", "10ns" },
+		{ "clock", "Clock at which requests enter the generator pipeline", "1GHz" },
+		{ "pipeline-depth", "Stages in the generator pipeline, each holds up to issue-width numbers for part of gentime", "1" },
+		{ "issue-width", "Numbers which may enter the pipeline each cycle", "1" },
+		{ "queue-capacity", "Requests which may wait for the pipeline, exceeding it is an error", "16" }
+		)
+
+	SST_ELI_DOCUMENT_STATISTICS(
+		{ "queue-occupancy", "Requests already waiting each time a request arrives", "requests", 1 },
+		{ "pipeline-occupancy", "Numbers being generated (including itself) each time one enters the pipeline", "numbers", 1 },
+		{ "batch-size", "Numbers asked for by each request", "numbers", 1 },
+		{ "busy-cycles", "Cycles with at least one request being generated, one sample per busy period", "cycles", 1 }
 		)
 
 	SST_ELI_DOCUMENT_PORTS(
 		{ "cpulink", "Link the CPU to the accelerator", { "juno.JunoGenerateRandEvent", "" } }
 		)
 protected:
+	bool tryIssue( JunoGenerateRandEvent* genEv );
+
 	SST::Output* output;
 	SST::Link* cpuLink;
 	SST::Link* selfGenerateLink;
 	MersenneRNG* rng;
+	// Only created when counter based generation is selected
+	JunoPhiloxRNG* philox;
+
+	// Requests wait here when the pipeline is full or this cycle's issue
+	// slots are used, the clock only runs while the queue is not empty
+	std::deque<JunoGenerateRandEvent*> waitQueue;
+	std::unordered_map<int, JunoRandBatch> batches;
+	uint32_t maxInFlight;
+	uint32_t issueWidth;
+	uint32_t queueCapacity;
+	uint32_t inFlight;
+	uint32_t issuedThisCycle;
+	SST::Cycle_t lastIssueCycle;
+	SST::Cycle_t busyStartCycle;
+	bool clockRunning;
+
+	SST::TimeConverter* accClockTC;
+	SST::Clock::Handler<JunoRandAccelerator>* accClockHandler;
+
+	Statistic<uint64_t>* statQueueOccupancy;
+	Statistic<uint64_t>* statPipelineOccupancy;
+	Statistic<uint64_t>* statBusyCycles;
+	Statistic<uint64_t>* statBatchSize;
 
 };
 
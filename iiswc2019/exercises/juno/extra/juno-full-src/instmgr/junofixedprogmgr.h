@@ -19,6 +19,9 @@
 #define _H_SST_JUNO_FIXED_PRG_MGR
 
 #include <cinttypes>
+#include <cstring>
+#include <vector>
+
 #include "junoinstmgr.h"
 
 namespace SST {
@@ -27,11 +30,20 @@ namespace SST {
         class JunoFixedPrgInstMgr : public JunoInstructionMgr {
             
         public:
-            JunoFixedPrgInstMgr( const char* buff, const uint64_t length ) :
-            JunoInstructionMgr(), maxLen(length) {
+            JunoFixedPrgInstMgr( const char* text, const uint64_t textStart, const uint64_t textLength ) :
+            JunoInstructionMgr(), textBase(textStart) {
+                
+                // Decode the whole program once, fetches are then a simple
+                // index into the decoded array
+                const uint64_t instCount = textLength / 4;
+                decoded.reserve( instCount );
                 
-                buffer = (char*) malloc( sizeof(char) * maxLen );
-                memcpy( buffer, buff, maxLen );
+                for( uint64_t i = 0; i < instCount; ++i ) {
+                    int32_t instCode = 0;
+                    memcpy( (void*) &instCode, &text[i * 4], sizeof(instCode) );
+                    
+                    decoded.push_back( JunoCPUInstruction( instCode ) );
+                }
             }
             ~JunoFixedPrgInstMgr() {}
             
@@ -39,18 +51,36 @@ namespace SST {
                 return true;
             }
             
-            JunoCPUInstruction* getInstruction( const uint64_t addr ) {
-                int32_t instCode = 0;
-                
-                memcpy( (void*) &instCode, &buffer[addr], sizeof(instCode) );
-                JunoCPUInstruction* inst = new JunoCPUInstruction( instCode);
+            const JunoCPUInstruction& getInstruction( const uint64_t addr ) {
+                return decoded[ (addr - textBase) >> 2 ];
+            }
+            
+            void updateText( const uint64_t addr, const uint8_t* data, const uint64_t len ) {
+                const uint64_t textEnd = textBase + (decoded.size() * 4);
                 
-                return inst;
+                for( uint64_t i = 0; i < len; ++i ) {
+                    const uint64_t byteAddr = addr + i;
+                    
+                    if( byteAddr < textBase || byteAddr >= textEnd ) {
+                        continue;
+                    }
+                    
+                    // Records hold every field of the encoding so the
+                    // original word can be rebuilt, patched and decoded
+                    JunoCPUInstruction& inst = decoded[ (byteAddr - textBase) >> 2 ];
+                    uint8_t encoded[4] = { inst.getInstCode(), inst.getReadReg1(),
+                        inst.getReadReg2(), inst.getWriteReg() };
+                    encoded[ (byteAddr - textBase) & 0x3 ] = data[i];
+                    
+                    int32_t instCode = 0;
+                    memcpy( (void*) &instCode, encoded, sizeof(instCode) );
+                    inst = JunoCPUInstruction( instCode );
+                }
             }
             
         protected:
-            char* buffer;
-            uint64_t maxLen;
+            std::vector<JunoCPUInstruction> decoded;
+            uint64_t textBase;
             
         };
         
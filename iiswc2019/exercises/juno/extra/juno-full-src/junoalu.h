@@ -22,11 +22,12 @@
 
 #include "junocpuinst.h"
 #include "junoregfile.h"
+#include "junoverbose.h"
 
 namespace SST {
     namespace Juno {
         
-        void executeAdd( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
+        inline void executeAdd( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
             const uint8_t opLeft    = inst->getReadReg1();
             const uint8_t opRight   = inst->getReadReg2();
             const uint8_t resultReg = inst->getWriteReg();
@@ -36,25 +37,25 @@ namespace SST {
             
             const int64_t result    = valLeft + valRight;
             
-            output.verbose(CALL_INFO, 4, 0, "ADD[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " + %" PRId64 " = %" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "ADD[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " + %" PRId64 " = %" PRId64 ")\n",
                            opLeft, opRight, resultReg, valLeft, valRight, result);
             
             regFile->writeReg( resultReg, result );
         };
 
-        void executeNot( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
+        inline void executeNot( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
             const uint8_t op        = inst->getReadReg1();
             const uint8_t resultReg = inst->getWriteReg();
 
             const int64_t val       = regFile->readReg(op);
             const int64_t result    = ~(val);
-            output.verbose(CALL_INFO, 4, 0, "NOT[r%3" PRIu8 ", res=r%3" PRIu8 "]: (~%" PRId64 " = %" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "NOT[r%3" PRIu8 ", res=r%3" PRIu8 "]: (~%" PRId64 " = %" PRId64 ")\n",
                            op, resultReg, val, result);
 
             regFile->writeReg( resultReg, result );
         };
         
-        void executeSub( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
+        inline void executeSub( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
             const uint8_t opLeft    = inst->getReadReg1();
             const uint8_t opRight   = inst->getReadReg2();
             const uint8_t resultReg = inst->getWriteReg();
@@ -64,13 +65,13 @@ namespace SST {
             
             const int64_t result    = valLeft - valRight;
             
-            output.verbose(CALL_INFO, 4, 0, "SUB[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " - %" PRId64 " = %" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "SUB[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " - %" PRId64 " = %" PRId64 ")\n",
                            opLeft, opRight, resultReg, valLeft, valRight, result);
             
             regFile->writeReg( resultReg, result );
         };
         
-        void executeDiv( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
+        inline void executeDiv( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
             const uint8_t opLeft    = inst->getReadReg1();
             const uint8_t opRight   = inst->getReadReg2();
             const uint8_t resultReg = inst->getWriteReg();
@@ -80,13 +81,13 @@ namespace SST {
             
             const int64_t result    = valLeft / valRight;
             
-            output.verbose(CALL_INFO, 4, 0, "DIV[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " / %" PRId64 " = %" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "DIV[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " / %" PRId64 " = %" PRId64 ")\n",
                            opLeft, opRight, resultReg, valLeft, valRight, result);
             
             regFile->writeReg( resultReg, result );
         };
 
-        void executeMod( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
+        inline void executeMod( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
             const uint8_t opLeft    = inst->getReadReg1();
             const uint8_t opRight   = inst->getReadReg2();
             const uint8_t resultReg = inst->getWriteReg();
@@ -96,13 +97,13 @@ namespace SST {
             
             const int64_t result    = valLeft % valRight;
             
-            output.verbose(CALL_INFO, 4, 0, "MOD[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " mod %" PRId64 " = %" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "MOD[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " mod %" PRId64 " = %" PRId64 ")\n",
                            opLeft, opRight, resultReg, valLeft, valRight, result);
             
             regFile->writeReg( resultReg, result );
         };
         
-        void executeMul( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
+        inline void executeMul( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
             const uint8_t opLeft    = inst->getReadReg1();
             const uint8_t opRight   = inst->getReadReg2();
             const uint8_t resultReg = inst->getWriteReg();
@@ -112,13 +113,13 @@ namespace SST {
             
             const int64_t result    = valLeft * valRight;
             
-            output.verbose(CALL_INFO, 4, 0, "MUL[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " * %" PRId64 " = %" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "MUL[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " * %" PRId64 " = %" PRId64 ")\n",
                            opLeft, opRight, resultReg, valLeft, valRight, result);
             
             regFile->writeReg( resultReg, result );
         };
         
-        void executeAnd( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
+        inline void executeAnd( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
             const uint8_t opLeft    = inst->getReadReg1();
             const uint8_t opRight   = inst->getReadReg2();
             const uint8_t resultReg = inst->getWriteReg();
@@ -128,13 +129,13 @@ namespace SST {
             
             const int64_t result    = valLeft & valRight;
             
-            output.verbose(CALL_INFO, 4, 0, "AND[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " & %" PRId64 " = %" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "AND[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " & %" PRId64 " = %" PRId64 ")\n",
                            opLeft, opRight, resultReg, valLeft, valRight, result);
             
             regFile->writeReg( resultReg, result );
         };
         
-        void executeOr( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
+        inline void executeOr( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
             const uint8_t opLeft    = inst->getReadReg1();
             const uint8_t opRight   = inst->getReadReg2();
             const uint8_t resultReg = inst->getWriteReg();
@@ -144,13 +145,13 @@ namespace SST {
             
             const int64_t result    = valLeft | valRight;
             
-            output.verbose(CALL_INFO, 4, 0, "OR[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " | %" PRId64 " = %" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "OR[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " | %" PRId64 " = %" PRId64 ")\n",
                            opLeft, opRight, resultReg, valLeft, valRight, result);
             
             regFile->writeReg( resultReg, result );
         };
         
-        void executeXor( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
+        inline void executeXor( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile ) {
             const uint8_t opLeft    = inst->getReadReg1();
             const uint8_t opRight   = inst->getReadReg2();
             const uint8_t resultReg = inst->getWriteReg();
@@ -160,15 +161,12 @@ namespace SST {
             
             const int64_t result    = valLeft ^ valRight;
             
-            output.verbose(CALL_INFO, 4, 0, "XOR[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " ^ %" PRId64 " = %" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "XOR[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]: (%" PRId64 " ^ %" PRId64 " = %" PRId64 ")\n",
                            opLeft, opRight, resultReg, valLeft, valRight, result);
             
             regFile->writeReg( resultReg, result );
         };
         
-        
-        
-        
     }
 }
 
@@ -0,0 +1,125 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_BLOCK_CACHE
+#define _H_SST_JUNO_BLOCK_CACHE
+
+#include <algorithm>
+#include <cinttypes>
+#include <vector>
+
+#include "junoinstmgr.h"
+#include "junodispatch.h"
+
+namespace SST {
+    namespace Juno {
+
+        // A run of register-only ALU operations which can be executed
+        // back-to-back, the run stops in front of the first jump, memory
+        // operation or other instruction which must be issued on its own
+        class JunoBasicBlock {
+
+        public:
+            JunoBasicBlock() : length(0), cycles(0), built(false) {}
+
+            uint32_t length;
+            SST::Cycle_t cycles;
+            bool built;
+
+        };
+
+        class JunoBasicBlockCache {
+
+        public:
+            JunoBasicBlockCache( JunoInstructionMgr* mgr, const JunoDispatchEntry* dispatch,
+                const uint64_t textStart, const uint64_t textLength ) :
+                instMgr(mgr), dispatchTable(dispatch), textBase(textStart),
+                textEnd(textStart + textLength) {
+
+                blocks.resize( textLength / 4 );
+            }
+
+            ~JunoBasicBlockCache() {}
+
+            static bool isBlockOp( const JunoDispatchEntry& entry ) {
+                return (entry.kind >= JUNO_DISPATCH_ADD) && (entry.kind <= JUNO_DISPATCH_NOT);
+            }
+
+            const JunoBasicBlock& getBlock( const uint64_t pc ) {
+                JunoBasicBlock& block = blocks[ (pc - textBase) >> 2 ];
+
+                if( ! block.built ) {
+                    buildBlock( pc, block );
+                }
+
+                return block;
+            }
+
+            // A store landed on [addr, addr+len) of the text segment, drop
+            // every block which covers or ends on the modified instructions
+            void invalidate( const uint64_t addr, const uint64_t len ) {
+                const uint64_t first = (std::max( addr, textBase ) - textBase) >> 2;
+                const uint64_t last  = (std::min( addr + len, textEnd ) - 1 - textBase) >> 2;
+
+                for( uint64_t i = first; i <= last; ++i ) {
+                    blocks[i] = JunoBasicBlock();
+                }
+
+                // Blocks starting earlier reach these instructions only
+                // through an unbroken run of ALU operations
+                for( uint64_t i = first; i > 0; --i ) {
+                    const uint64_t prevPC = textBase + ((i - 1) << 2);
+
+                    if( ! isBlockOp( dispatchTable[ instMgr->getInstruction( prevPC ).getInstCode() ] ) ) {
+                        break;
+                    }
+
+                    blocks[i - 1] = JunoBasicBlock();
+                }
+            }
+
+        protected:
+            void buildBlock( const uint64_t pc, JunoBasicBlock& block ) {
+                block.length = 0;
+                block.cycles = 0;
+
+                for( uint64_t nextPC = pc; nextPC < textEnd; nextPC += 4 ) {
+                    const JunoDispatchEntry& entry = dispatchTable[ instMgr->getInstruction( nextPC ).getInstCode() ];
+
+                    if( ! isBlockOp( entry ) ) {
+                        break;
+                    }
+
+                    block.length++;
+                    block.cycles += entry.cycles;
+                }
+
+                block.built = true;
+            }
+
+            JunoInstructionMgr* instMgr;
+            const JunoDispatchEntry* dispatchTable;
+            const uint64_t textBase;
+            const uint64_t textEnd;
+            std::vector<JunoBasicBlock> blocks;
+
+        };
+
+    }
+}
+
+#endif
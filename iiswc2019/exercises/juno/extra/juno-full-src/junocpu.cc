@@ -15,7 +15,10 @@
 
 
 #include <sst/core/sst_config.h>
+#include <sst/core/unitAlgebra.h>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 #include "junocpu.h"
@@ -35,6 +38,11 @@ JunoCPU::JunoCPU( SST::ComponentId_t id, SST::Params& params ) :
 SST::Component(id) {
     const int verbosity = params.find<int>("verbose", 0);
     output.init("Juno[" + getName() + ":@p:@t]: ", verbosity, 0, SST::Output::STDOUT);
+
+    if( verbosity > JUNO_MAX_VERBOSE ) {
+        output.verbose(CALL_INFO, 1, 0, "Verbosity %d requested but messages above %d were compiled out (JUNO_MAX_VERBOSE)\n",
+            verbosity, JUNO_MAX_VERBOSE);
+    }
     
     std::string memIFace = params.find<std::string>("meminterface", "memHierarchy.memInterface");
     output.verbose(CALL_INFO, 1, 0, "Loading memory interface: %s ...\n", memIFace.c_str());
@@ -58,7 +66,17 @@ SST::Component(id) {
     
     // Just register a plain clock for this simple example
     std::string cpuClock = params.find<std::string>("clock", "1GHz");
-    registerClock(cpuClock, new SST::Clock::Handler<JunoCPU>(this, &JunoCPU::clockTick));
+    cpuClockHandler = new SST::Clock::Handler<JunoCPU>(this, &JunoCPU::clockTick);
+    cpuClockTC = registerClock(cpuClock, cpuClockHandler);
+
+    // The clock is switched off while the core waits on long operations, this
+    // link brings it back for operations with a known latency
+    wakeLink = configureSelfLink("clock-wake", cpuClockTC,
+	new Event::Handler<JunoCPU>(this, &JunoCPU::handleWake));
+    clockGated    = false;
+    gatedOnMemory = false;
+    gatedCycle    = 0;
+    gatedAccounted = 0;
     
     // Tell SST to wait until we authorize it to exit
     registerAsPrimaryComponent();
@@ -80,14 +98,20 @@ SST::Component(id) {
     progReader = new JunoProgramReader( progFileHandle , &output );
     
     fclose(progFileHandle);
+
+    initChunkSize = params.find<uint64_t>("init-chunk-size", 65536);
+
+    if( 0 == initChunkSize ) {
+	output.fatal(CALL_INFO, -1, "Error: init-chunk-size must be at least 1 byte\n");
+    }
     
     output.verbose(CALL_INFO, 1, 0, "Creating an instruction manager...\n");
-    instMgr = new JunoFixedPrgInstMgr( progReader->getBinaryBuffer(), (progReader->getDataLength() + progReader->getInstLength()) );
+    instMgr = new JunoFixedPrgInstMgr( progReader->getTextBuffer(), progReader->getDataLength(), progReader->getInstLength() );
     
     instCyclesLeft = 0;
     pc = progReader->getDataLength();
     
-    output.verbose(CALL_INFO, 1, 0, "PC set to: %" PRIu64 "\n", pc);
+    output.verbose(CALL_INFO, 1, 0, "PC set to: %" PRIu64 "%s\n", pc, describeAddress( pc ).c_str());
 
     int maxReg = params.find<int>("registers", "8");
     output.verbose(CALL_INFO, 1, 0, "Creating a register file of %d 64-bit integer registers...\n", maxReg);
@@ -97,13 +121,96 @@ SST::Component(id) {
     output.verbose(CALL_INFO, 1, 0, "Creating load/store unit...\n");
 
     uint64_t maxLoadStoreAddr = params.find<uint64_t>("max-address", std::numeric_limits<uint64_t>::max());
-    ldStUnit = new JunoLoadStoreUnit( &output, mem, regFile, maxLoadStoreAddr );
+    uint32_t maxOutstandingLoads = params.find<uint32_t>("max-outstanding-loads", 1);
+
+    if( 0 == maxOutstandingLoads ) {
+	output.fatal(CALL_INFO, -1, "Error: max-outstanding-loads must be at least 1\n");
+    }
+
+    const uint64_t cacheLineSize = params.find<uint64_t>("cache-line-size", 64);
+
+    if( cacheLineSize < 8 || 0 != (cacheLineSize & (cacheLineSize - 1)) ) {
+	output.fatal(CALL_INFO, -1, "Error: cache-line-size (%" PRIu64 ") must be a power of two of at least 8 bytes\n", cacheLineSize);
+    }
+
+    const uint32_t storeBufferDepth = params.find<uint32_t>("store-buffer-depth", 8);
+    const uint64_t storeBufferLine  = params.find<uint64_t>("store-buffer-line", 64);
+    storeBuffer = NULL;
+
+    if( storeBufferDepth > 0 ) {
+	output.verbose(CALL_INFO, 1, 0, "Creating a %" PRIu32 " entry store buffer of %" PRIu64 " byte lines\n",
+		storeBufferDepth, storeBufferLine);
+
+	storeBuffer = new JunoStoreBuffer( &output, mem, storeBufferDepth, storeBufferLine,
+		registerStatistic<uint64_t>( "store-buffer-writes" ),
+		registerStatistic<uint64_t>( "store-buffer-combined" ),
+		registerStatistic<uint64_t>( "store-buffer-forwards" ) );
+    }
+
+    output.verbose(CALL_INFO, 1, 0, "Load/store unit allows %" PRIu32 " outstanding loads\n", maxOutstandingLoads);
+    ldStUnit = new JunoLoadStoreUnit( &output, mem, regFile, maxLoadStoreAddr, maxOutstandingLoads, storeBuffer,
+	cacheLineSize );
+
+    const uint32_t hwThreads = params.find<uint32_t>("hw-threads", 1);
+
+    if( 0 == hwThreads ) {
+	output.fatal(CALL_INFO, -1, "Error: hw-threads must be at least 1\n");
+    }
+
+    // Every thread starts at the program entry with its own registers and
+    // load table, memory and the store buffer are shared. All register
+    // files mirror the CPU's pc into r0, it holds the active thread's PC.
+    threads.resize( hwThreads );
+    threads[0].pc       = pc;
+    threads[0].regFile  = regFile;
+    threads[0].ldStUnit = ldStUnit;
+
+    for( uint32_t t = 1; t < hwThreads; ++t ) {
+	threads[t].pc       = pc;
+	threads[t].regFile  = new JunoRegisterFile(&output, maxReg, &pc, progReader->getDataLength() +
+		progReader->getInstLength() + progReader->getPadding() );
+	threads[t].ldStUnit = new JunoLoadStoreUnit( &output, mem, threads[t].regFile, maxLoadStoreAddr,
+		maxOutstandingLoads, storeBuffer, cacheLineSize );
+    }
+
+    activeThread     = 0;
+    lastIssuedThread = hwThreads - 1;
+    liveThreads      = hwThreads;
+
+    const std::string policyName = params.find<std::string>("fetch-policy", "round-robin");
+
+    if( "round-robin" == policyName ) {
+	fetchPolicy = JUNO_FETCH_ROUND_ROBIN;
+    } else if( "icount" == policyName ) {
+	fetchPolicy = JUNO_FETCH_ICOUNT;
+    } else {
+	output.fatal(CALL_INFO, -1, "Error: unknown fetch-policy: %s (use round-robin or icount)\n", policyName.c_str());
+    }
+
+    const int threadIDReg = params.find<int>("thread-id-register", 0);
+
+    if( 0 != threadIDReg ) {
+	if( threadIDReg < 2 || threadIDReg >= maxReg ) {
+	    output.fatal(CALL_INFO, -1, "Error: thread-id-register (%d) must be a general purpose register (2 to %d)\n",
+		threadIDReg, maxReg - 1);
+	}
+
+	for( uint32_t t = 0; t < hwThreads; ++t ) {
+	    threads[t].regFile->writeReg( static_cast<uint8_t>(threadIDReg), static_cast<int64_t>(t) );
+	}
+    }
+
+    if( hwThreads > 1 ) {
+	output.verbose(CALL_INFO, 1, 0, "Running %" PRIu32 " hardware threads, %s fetch\n", hwThreads, policyName.c_str());
+    }
 
     output.verbose(CALL_INFO, 1, 0, "Loading custom instructions...\n");
 
     SubComponentSlotInfo* handlerSlot = getSubComponentSlotInfo("customhandler");
     std::vector<SubComponent*> subComps;
     handlerCount = 0;
+    handlersWaiting = 0;
+    handlerRequests = 0;
 
     if( NULL != handlerSlot ) {
 	handlerSlot->createAll( subComps );
@@ -112,6 +219,7 @@ SST::Component(id) {
 		JunoCustomInstructionHandler* nextHandler = dynamic_cast<JunoCustomInstructionHandler*>( subComps[i] );
 
 		if( NULL != nextHandler ) {
+			nextHandler->attach( this, cpuClockTC );
 			customHandlers.push_back(nextHandler);
 		}
 	}
@@ -131,6 +239,35 @@ SST::Component(id) {
     orCycles  = params.find<SST::Cycle_t>("cycles-or", 1);
     notCycles  = params.find<SST::Cycle_t>("cycles-not", 1);
 
+    issueWidth = params.find<uint32_t>("issue-width", 1);
+
+    if( 0 == issueWidth || issueWidth > JUNO_MAX_ISSUE_WIDTH ) {
+	output.fatal(CALL_INFO, -1, "Error: issue-width (%" PRIu32 ") must be from 1 to %d\n", issueWidth, JUNO_MAX_ISSUE_WIDTH);
+    }
+
+    if( issueWidth > 1 && threads.size() > 1 ) {
+	output.fatal(CALL_INFO, -1, "Error: issue-width > 1 cannot be combined with hw-threads > 1\n");
+    }
+
+    if( issueWidth > 1 ) {
+	unitPools[JUNO_UNIT_ALU].resize( params.find<uint32_t>("fu-alu", issueWidth) );
+	unitPools[JUNO_UNIT_MULDIV].resize( params.find<uint32_t>("fu-muldiv", 1) );
+	unitPools[JUNO_UNIT_LSU].resize( params.find<uint32_t>("fu-lsu", 1) );
+	unitPools[JUNO_UNIT_CUSTOM].resize( params.find<uint32_t>("fu-custom", 1) );
+
+	for( int unitClass = JUNO_UNIT_ALU; unitClass < JUNO_UNIT_COUNT; ++unitClass ) {
+	    if( 0 == unitPools[unitClass].size() ) {
+		output.fatal(CALL_INFO, -1, "Error: every functional unit class needs at least one unit\n");
+	    }
+	}
+
+	output.verbose(CALL_INFO, 1, 0, "Issuing up to %" PRIu32 " instructions per cycle (%" PRIu32 " ALU, %" PRIu32 " MUL/DIV, %" PRIu32 " LSU, %" PRIu32 " custom units)\n",
+		issueWidth, unitPools[JUNO_UNIT_ALU].size(), unitPools[JUNO_UNIT_MULDIV].size(),
+		unitPools[JUNO_UNIT_LSU].size(), unitPools[JUNO_UNIT_CUSTOM].size());
+    }
+
+    regReadyCycle.assign( static_cast<size_t>( std::max( maxReg, 2 ) ), 0 );
+
     output.verbose(CALL_INFO, 1, 0, "Configuring statistics...\n");
 
     statCycles       = registerStatistic<uint64_t>( "cycles" );
@@ -147,59 +284,554 @@ SST::Component(id) {
     statOrIns        = registerStatistic<uint64_t>( "or-ins-count" );
     statXorIns       = registerStatistic<uint64_t>( "xor-ins-count" );
     statNotIns       = registerStatistic<uint64_t>( "not-ins-count" );
+    statFFInstructions = registerStatistic<uint64_t>( "ff-instructions" );
+    statLoadMLP        = registerStatistic<uint64_t>( "load-mlp" );
+    statScoreboardStalls = registerStatistic<uint64_t>( "scoreboard-stalls" );
+    statIssueGroupSize   = registerStatistic<uint64_t>( "issue-group-size" );
+    statFUStalls         = registerStatistic<uint64_t>( "fu-stalls" );
+
+    if( threads.size() > 1 ) {
+	for( size_t t = 0; t < threads.size(); ++t ) {
+	    threads[t].statInstructions = registerStatistic<uint64_t>( "thread-instructions", std::to_string(t) );
+	    threads[t].statStallCycles  = registerStatistic<uint64_t>( "thread-stall-cycles", std::to_string(t) );
+	}
+    }
+
+    // Hot path counters are kept locally and pushed into the statistics at
+    // this period and in finish(). By default that is the statistics' own
+    // output rate when they are dumped periodically, component clocks run
+    // before statistic output in the same cycle so each dump is current.
+    std::string statFlushPeriod = params.find<std::string>("stat-flush-period", "");
+
+    if( "" == statFlushPeriod ) {
+	const UnitAlgebra& outputRate = statCycles->getCollectionRate();
+
+	if( outputRate.getRoundedValue() > 0 && (outputRate.hasUnits("s") || outputRate.hasUnits("Hz")) ) {
+	    statFlushPeriod = outputRate.toStringBestSI();
+	}
+    }
+
+    if( "" != statFlushPeriod ) {
+	output.verbose(CALL_INFO, 1, 0, "Flushing statistics every %s\n", statFlushPeriod.c_str());
+	registerClock( statFlushPeriod, new SST::Clock::Handler<JunoCPU>(this, &JunoCPU::handleStatFlush) );
+    }
+
+    output.verbose(CALL_INFO, 1, 0, "Building instruction dispatch table...\n");
+    buildDispatchTable();
+
+    output.verbose(CALL_INFO, 1, 0, "Validating register use in the program text...\n");
+
+    for( uint64_t textAddr = progReader->getDataLength();
+	textAddr + 4 <= progReader->getDataLength() + progReader->getInstLength(); textAddr += 4 ) {
+	validateInstruction( textAddr );
+    }
+
+    blockCache = NULL;
+
+    // Blocks are charged as one serial delay, the multi-issue and
+    // multithreaded models time each instruction itself
+    if( params.find<bool>("block-cache", true) && 1 == issueWidth && 1 == threads.size() ) {
+	output.verbose(CALL_INFO, 1, 0, "Creating basic block cache...\n");
+	blockCache = new JunoBasicBlockCache( instMgr, dispatchTable, progReader->getDataLength(),
+		progReader->getInstLength() );
+    }
+
+    const uint64_t ffInsts = params.find<uint64_t>("fastforward-instructions", 0);
+    sampleLength      = params.find<uint64_t>("sample-length", 0);
+    sampleInterval    = params.find<uint64_t>("sample-interval", 0);
+    samplingEnabled   = (ffInsts > 0) || (sampleLength > 0);
+    fastForwarding    = (ffInsts > 0);
+    ffInstLeft        = ffInsts;
+    windowInsts       = 0;
+    windowStartCycle  = 0;
+    ffInstTotal       = 0;
+    detailedInstTotal = 0;
+    ffLineBytes       = cacheLineSize;
+    ffLastLine        = UINT64_MAX;
+    ffWarmNext        = 0;
+    ffWarmUsed        = 0;
+    ffPushed          = false;
+    shadowMem         = NULL;
+
+    if( samplingEnabled ) {
+	output.verbose(CALL_INFO, 1, 0, "Sampling enabled: fast-forward %" PRIu64 ", window %" PRIu64 ", interval %" PRIu64 " instructions\n",
+		ffInsts, sampleLength, sampleInterval);
+
+	if( threads.size() > 1 ) {
+	    output.fatal(CALL_INFO, -1, "Error: sampling cannot be combined with hw-threads > 1\n");
+	}
+
+	if( (sampleInterval > 0) && (sampleInterval < sampleLength) ) {
+	    output.fatal(CALL_INFO, -1, "Error: sample-interval (%" PRIu64 ") must not be less than sample-length (%" PRIu64 ")\n",
+		sampleInterval, sampleLength);
+	}
+
+	ffWarmLines.resize( params.find<uint32_t>("fastforward-warm-lines", 1024) );
+
+	// Fast-forward runs against the shadow copy only, the bytes it stores
+	// are sent to memory when detailed simulation starts
+	shadowMem = new JunoShadowMemory();
+
+	for( size_t i = 0; i < progReader->getExtentCount(); ++i ) {
+	    const JunoProgramExtent& extent = progReader->getExtent( i );
+	    shadowMem->write( extent.addr, reinterpret_cast<const uint8_t*>( extent.bytes ), extent.length );
+	}
+    }
 	
     output.verbose(CALL_INFO, 1, 0, "Initialization done.\n");
 }
 
+void JunoCPU::setDispatch( const uint8_t opCode, JunoExecuteFunc execFunc, JunoDispatchKind kind,
+	const bool advancePC, const SST::Cycle_t cycles, Statistic<uint64_t>* opStat, const uint32_t operands ) {
+
+    JunoDispatchEntry& entry = dispatchTable[opCode];
+
+    entry.execute   = execFunc;
+    entry.kind      = kind;
+    entry.advancePC = advancePC;
+    entry.cycles    = cycles;
+    entry.operands  = operands;
+    entry.opStat    = opStat;
+    entry.handler   = NULL;
+}
+
+void JunoCPU::buildDispatchTable() {
+    const uint32_t aluOperands = JUNO_OPERAND_READ1 | JUNO_OPERAND_READ2 | JUNO_OPERAND_WRITE;
+
+    for( int i = 0; i < 256; ++i ) {
+	setDispatch( static_cast<uint8_t>(i), &JunoCPU::dispatchUnknown, JUNO_DISPATCH_UNKNOWN, false, 0, NULL, JUNO_OPERAND_NONE );
+    }
+
+    setDispatch( JUNO_NOOP,      &JunoCPU::dispatchNoop, JUNO_DISPATCH_NOOP, true, 1, NULL, JUNO_OPERAND_NONE );
+    setDispatch( JUNO_HALT,      &JunoCPU::dispatchHalt, JUNO_DISPATCH_HALT, false, 0, NULL, JUNO_OPERAND_NONE );
+
+    setDispatch( JUNO_LOAD,      &JunoCPU::dispatchMem<executeLoad>,  JUNO_DISPATCH_LOAD,      true, 0, statMemReads,
+	JUNO_OPERAND_READ1 | JUNO_OPERAND_WRITE );
+    setDispatch( JUNO_LOAD_ADDR, &JunoCPU::dispatchMem<executeLDA>,   JUNO_DISPATCH_LOAD_ADDR, true, 0, statMemReads,
+	JUNO_OPERAND_WRITE );
+    setDispatch( JUNO_STORE,     &JunoCPU::dispatchStore,             JUNO_DISPATCH_STORE,     true, 0, statMemWrites,
+	JUNO_OPERAND_READ1 | JUNO_OPERAND_READ2 );
+
+    // The register groups of vector forms are checked in validateInstruction
+    setDispatch( JUNO_VLOAD,     &JunoCPU::dispatchMem<executeVectorLoad>, JUNO_DISPATCH_VLOAD,   true, 0, statMemReads,
+	JUNO_OPERAND_READ1 | JUNO_OPERAND_WRITE );
+    setDispatch( JUNO_VGATHER,   &JunoCPU::dispatchMem<executeGather>,     JUNO_DISPATCH_VGATHER, true, 0, statMemReads,
+	JUNO_OPERAND_READ1 | JUNO_OPERAND_WRITE );
+    setDispatch( JUNO_VSTORE,    &JunoCPU::dispatchVectorStore,            JUNO_DISPATCH_VSTORE,  true, 0, statMemWrites,
+	JUNO_OPERAND_READ1 );
+
+    setDispatch( JUNO_ADD,       &JunoCPU::dispatchALU<executeAdd>, JUNO_DISPATCH_ADD, true, addCycles, statAddIns, aluOperands );
+    setDispatch( JUNO_SUB,       &JunoCPU::dispatchALU<executeSub>, JUNO_DISPATCH_SUB, true, subCycles, statSubIns, aluOperands );
+    setDispatch( JUNO_MUL,       &JunoCPU::dispatchALU<executeMul>, JUNO_DISPATCH_MUL, true, mulCycles, statMulIns, aluOperands );
+    setDispatch( JUNO_DIV,       &JunoCPU::dispatchALU<executeDiv>, JUNO_DISPATCH_DIV, true, divCycles, statDivIns, aluOperands );
+    setDispatch( JUNO_MOD,       &JunoCPU::dispatchALU<executeMod>, JUNO_DISPATCH_MOD, true, modCycles, statModIns, aluOperands );
+    setDispatch( JUNO_AND,       &JunoCPU::dispatchALU<executeAnd>, JUNO_DISPATCH_AND, true, andCycles, statAndIns, aluOperands );
+    setDispatch( JUNO_OR,        &JunoCPU::dispatchALU<executeOr>,  JUNO_DISPATCH_OR,  true, orCycles,  statOrIns,  aluOperands );
+    setDispatch( JUNO_XOR,       &JunoCPU::dispatchALU<executeXor>, JUNO_DISPATCH_XOR, true, xorCycles, statXorIns, aluOperands );
+    setDispatch( JUNO_NOT,       &JunoCPU::dispatchALU<executeNot>, JUNO_DISPATCH_NOT, true, notCycles, statNotIns,
+	JUNO_OPERAND_READ1 | JUNO_OPERAND_WRITE );
+
+    setDispatch( JUNO_PCR_JUMP_ZERO, &JunoCPU::dispatchJump<executeJumpZero>, JUNO_DISPATCH_JUMP_ZERO, false, 0, NULL, JUNO_OPERAND_READ1 );
+    setDispatch( JUNO_PCR_JUMP_LTZ,  &JunoCPU::dispatchJump<executeJumpLTZ>,  JUNO_DISPATCH_JUMP_LTZ,  false, 0, NULL, JUNO_OPERAND_READ1 );
+    setDispatch( JUNO_PCR_JUMP_GTZ,  &JunoCPU::dispatchJump<executeJumpGTZ>,  JUNO_DISPATCH_JUMP_GTZ,  false, 0, NULL, JUNO_OPERAND_READ1 );
+
+    // Custom handlers claim any op-codes not already taken by the core, the
+    // first handler to claim an op-code owns it. Handlers move the PC themselves.
+    for( size_t i = 0; i < customHandlers.size(); ++i ) {
+	for( int op = 0; op < 256; ++op ) {
+	    if( JUNO_DISPATCH_UNKNOWN == dispatchTable[op].kind &&
+		customHandlers[i]->canProcessInst( static_cast<uint8_t>(op) ) ) {
+
+		const uint32_t operands = JUNO_OPERAND_READ1 | JUNO_OPERAND_READ2 |
+			(customHandlers[i]->writesRegister( static_cast<uint8_t>(op) ) ? JUNO_OPERAND_WRITE : JUNO_OPERAND_NONE);
+
+		setDispatch( static_cast<uint8_t>(op), &JunoCPU::dispatchCustom, JUNO_DISPATCH_CUSTOM, false, 0, NULL, operands );
+		dispatchTable[op].handler = customHandlers[i];
+
+		output.verbose(CALL_INFO, 2, 0, "Op-code %d is handled by custom handler %d\n", op, static_cast<int>(i));
+	    }
+	}
+    }
+}
+
+// " (LABEL+offset, line N)" for binaries which carry symbol and line tables,
+// empty otherwise
+std::string JunoCPU::describeAddress( const uint64_t addr ) const {
+    uint64_t symOffset = 0;
+    const char* symName = progReader->findSymbol( addr, &symOffset );
+    const uint32_t line = progReader->findSourceLine( addr );
+    char location[256];
+
+    if( NULL != symName && 0 != line ) {
+	snprintf( location, sizeof(location), " (%s+%" PRIu64 ", line %" PRIu32 ")", symName, symOffset, line );
+    } else if( NULL != symName ) {
+	snprintf( location, sizeof(location), " (%s+%" PRIu64 ")", symName, symOffset );
+    } else if( 0 != line ) {
+	snprintf( location, sizeof(location), " (line %" PRIu32 ")", line );
+    } else {
+	location[0] = '\0';
+    }
+
+    return std::string( location );
+}
+
+// Register numbers are checked here, once per decoded instruction, rather
+// than on every register file access
+void JunoCPU::validateInstruction( const uint64_t addr ) {
+    const JunoCPUInstruction& inst = instMgr->getInstruction( addr );
+    const JunoDispatchEntry& entry = dispatchTable[ inst.getInstCode() ];
+
+    const uint8_t fields[3] = { inst.getReadReg1(), inst.getReadReg2(), inst.getWriteReg() };
+    const uint32_t usage[3] = { JUNO_OPERAND_READ1, JUNO_OPERAND_READ2, JUNO_OPERAND_WRITE };
+
+    for( int i = 0; i < 3; ++i ) {
+	if( 0 != (entry.operands & usage[i]) && ! regFile->isValidRegister( fields[i] ) ) {
+	    output.fatal(CALL_INFO, -1, "Instruction at %" PRIu64 "%s accessed register %" PRIu8 ", but max is: %d.\n",
+		addr, describeAddress( addr ).c_str(), fields[i], regFile->getRegisterCount());
+	}
+    }
+
+    if( 0 != (entry.operands & JUNO_OPERAND_WRITE) && inst.getWriteReg() <= 1 ) {
+	output.fatal(CALL_INFO, -1, "Instruction at %" PRIu64 "%s attempts write to register %" PRIu8 " but r0 and r1 are hardware reserved.\n",
+	    addr, describeAddress( addr ).c_str(), inst.getWriteReg());
+    }
+
+    if( junoIsVector( entry.kind ) ) {
+	const int count   = inst.getReadReg2();
+	const int lastReg = inst.getWriteReg() + count - 1;
+	const int lastIdx = inst.getReadReg1() + count - 1;
+
+	if( count < 1 || count > JUNO_VECTOR_MAX_REGS ) {
+	    output.fatal(CALL_INFO, -1, "Instruction at %" PRIu64 "%s moves %d registers, vector operations move 1 to %d.\n",
+		addr, describeAddress( addr ).c_str(), count, JUNO_VECTOR_MAX_REGS);
+	}
+
+	if( lastReg >= regFile->getRegisterCount() ) {
+	    output.fatal(CALL_INFO, -1, "Instruction at %" PRIu64 "%s accessed registers %" PRIu8 " to %d, but max is: %d.\n",
+		addr, describeAddress( addr ).c_str(), inst.getWriteReg(), lastReg, regFile->getRegisterCount());
+	}
+
+	// Every index is read at issue, a destination in the index group
+	// could be written first by a store buffer forward
+	if( JUNO_DISPATCH_VGATHER == entry.kind ) {
+	    if( lastIdx >= regFile->getRegisterCount() ) {
+		output.fatal(CALL_INFO, -1, "Instruction at %" PRIu64 "%s accessed registers %" PRIu8 " to %d, but max is: %d.\n",
+		    addr, describeAddress( addr ).c_str(), inst.getReadReg1(), lastIdx, regFile->getRegisterCount());
+	    }
+
+	    if( inst.getReadReg1() <= lastReg && inst.getWriteReg() <= lastIdx ) {
+		output.fatal(CALL_INFO, -1, "Instruction at %" PRIu64 "%s gathers into registers which overlap its index registers.\n",
+		    addr, describeAddress( addr ).c_str());
+	    }
+	}
+    }
+}
+
+template<void (*ALUOp)( SST::Output&, const JunoCPUInstruction*, JunoRegisterFile* )>
+bool JunoCPU::dispatchALU( JunoCPU* cpu, const JunoCPUInstruction* inst ) {
+    ALUOp( cpu->output, inst, cpu->regFile );
+    return false;
+}
+
+template<void (*MemOp)( SST::Output&, const JunoCPUInstruction*, JunoRegisterFile*, JunoLoadStoreUnit* )>
+bool JunoCPU::dispatchMem( JunoCPU* cpu, const JunoCPUInstruction* inst ) {
+    MemOp( cpu->output, inst, cpu->regFile, cpu->ldStUnit );
+    return false;
+}
+
+template<void (*JumpOp)( SST::Output&, const JunoCPUInstruction*, JunoRegisterFile*, uint64_t* )>
+bool JunoCPU::dispatchJump( JunoCPU* cpu, const JunoCPUInstruction* inst ) {
+    JumpOp( cpu->output, inst, cpu->regFile, &cpu->pc );
+    return false;
+}
+
+bool JunoCPU::dispatchStore( JunoCPU* cpu, const JunoCPUInstruction* inst ) {
+    executeStore( cpu->output, inst, cpu->regFile, cpu->ldStUnit );
+
+    cpu->recordStore( static_cast<uint64_t>( cpu->regFile->readReg( inst->getReadReg2() ) ),
+	cpu->regFile->readReg( inst->getReadReg1() ) );
+
+    return false;
+}
+
+bool JunoCPU::dispatchVectorStore( JunoCPU* cpu, const JunoCPUInstruction* inst ) {
+    executeVectorStore( cpu->output, inst, cpu->regFile, cpu->ldStUnit );
+
+    const uint64_t storeAddr = static_cast<uint64_t>( cpu->regFile->readReg( inst->getReadReg1() ) );
+
+    for( uint8_t i = 0; i < inst->getReadReg2(); ++i ) {
+	cpu->recordStore( storeAddr + static_cast<uint64_t>(i) * 8, cpu->regFile->readReg( inst->getWriteReg() + i ) );
+    }
+
+    return false;
+}
+
+// Keep the shadow image and decoded text up to date with a stored word,
+// memory only has the fast-forwarded ones after pushShadowState
+void JunoCPU::recordStore( const uint64_t addr, const int64_t value ) {
+    if( NULL != shadowMem ) {
+	shadowMem->write64( addr, value, fastForwarding );
+    }
+
+    if( addr < (progReader->getDataLength() + progReader->getInstLength()) &&
+	(addr + 8) > progReader->getDataLength() ) {
+
+	handleTextStore( addr, value );
+    }
+}
+
+void JunoCPU::handleTextStore( const uint64_t addr, const int64_t value ) {
+    JUNO_VERBOSE(output, 2, "Store to address %" PRIu64 " modifies the program text\n", addr);
+
+    instMgr->updateText( addr, reinterpret_cast<const uint8_t*>( &value ), sizeof(value) );
+
+    const uint64_t textStart = progReader->getDataLength();
+    const uint64_t textEnd   = textStart + progReader->getInstLength();
+
+    for( uint64_t instAddr = std::max( addr, textStart ) & ~static_cast<uint64_t>(3);
+	instAddr < std::min( addr + sizeof(value), textEnd ); instAddr += 4 ) {
+
+	if( instAddr >= textStart && instAddr + 4 <= textEnd ) {
+	    validateInstruction( instAddr );
+	}
+    }
+
+    if( NULL != blockCache ) {
+	blockCache->invalidate( addr, sizeof(value) );
+    }
+}
+
+void JunoCPU::executeBlock( const JunoBasicBlock& block ) {
+    JUNO_VERBOSE(output, 4, "Executing basic block of %" PRIu32 " instructions (%" PRIu64 " cycles)\n",
+	block.length, static_cast<uint64_t>(block.cycles));
+
+    for( uint32_t i = 0; i < block.length; ++i ) {
+	const JunoCPUInstruction* nextInst = &instMgr->getInstruction( pc );
+	const JunoDispatchEntry& entry = dispatchTable[ nextInst->getInstCode() ];
+
+	regFile->syncPC();
+	entry.execute( this, nextInst );
+	counters.opCounts[ nextInst->getInstCode() ]++;
+	pc += 4;
+    }
+
+    counters.instructions += block.length;
+
+    // The whole block is charged as one delay, the next instruction
+    // issues exactly when it would have issued one at a time
+    instCyclesLeft = block.cycles;
+}
+
+bool JunoCPU::dispatchNoop( JunoCPU* cpu, const JunoCPUInstruction* inst ) {
+    return false;
+}
+
+bool JunoCPU::dispatchHalt( JunoCPU* cpu, const JunoCPUInstruction* inst ) {
+    cpu->primaryComponentOKToEndSim();
+    return true;
+}
+
+bool JunoCPU::dispatchCustom( JunoCPU* cpu, const JunoCPUInstruction* inst ) {
+    JunoCustomInstructionHandler* handler = cpu->dispatchTable[ inst->getInstCode() ].handler;
+    const uint32_t requestsBefore = handler->requestsOutstanding();
+    const int instStatus = handler->execute( &cpu->output, inst, cpu->regFile, cpu->ldStUnit, &cpu->pc );
+
+    if( instStatus != 0 ) {
+	fprintf(stderr, "ERROR: Unknown instruction encountered (return code %d)\n", instStatus);
+	exit(-1);
+    }
+
+    cpu->handlerRequests += handler->requestsOutstanding() - requestsBefore;
+
+    if( handler->awaitingCompletion() ) {
+	cpu->handlersWaiting++;
+    }
+
+    return false;
+}
+
+bool JunoCPU::dispatchUnknown( JunoCPU* cpu, const JunoCPUInstruction* inst ) {
+    fprintf(stderr, "ERROR: Unknown instruction encountered (return code %d)\n", 1);
+    exit(-1);
+
+    return false;
+}
+
 JunoCPU::~JunoCPU() {
     delete progReader;
-    delete regFile;
+
+    for( size_t t = 0; t < threads.size(); ++t ) {
+	delete threads[t].regFile;
+	delete threads[t].ldStUnit;
+    }
+
     delete mem;
+    delete blockCache;
+    delete shadowMem;
+    delete storeBuffer;
 }
 
 void JunoCPU::handleEvent( SimpleMem::Request* ev ) {
-    output.verbose(CALL_INFO, 4, 0, "Recv response from cache\n");
+    JUNO_VERBOSE(output, 4, "Recv response from cache\n");
+
+    // Sent by pushShadowState, the switch to detailed simulation waits for
+    // the last of them
+    if( ! ffBulkRequests.empty() && ffBulkRequests.erase( ev->id ) > 0 ) {
+	delete ev;
+
+	if( ffBulkRequests.empty() && clockGated ) {
+	    ungateClock();
+	}
+
+	return;
+    }
+
+    // Find the thread which sent the request, store buffer writes belong
+    // to none of them and go to whichever is active
+    JunoLoadStoreUnit* respUnit = ldStUnit;
+    JunoRegisterFile* respRegs  = regFile;
+
+    if( threads.size() > 1 ) {
+        for( size_t t = 0; t < threads.size(); ++t ) {
+            if( threads[t].ldStUnit->ownsRequest( ev->id ) ) {
+                respUnit = threads[t].ldStUnit;
+                respRegs = threads[t].regFile;
+                break;
+            }
+        }
+    }
 
     if( ev->cmd == Interfaces::SimpleMem::Request::Command::ReadResp ) {
-        // Read request needs some special handling
-        uint8_t regTarget = ldStUnit->lookupEntry( ev->id );
-        int64_t newValue = 0;
+        // Read request needs some special handling, vector loads bring
+        // a word for each register of their group
+        const JunoLoadStoreEntry& entry = respUnit->lookupEntry( ev->id );
+
+        for( uint8_t i = 0; i < entry.getRegisterCount(); ++i ) {
+            const uint8_t regTarget = entry.getRegister() + i;
+            int64_t newValue = 0;
 
-        memcpy( (void*) &newValue, &ev->data[0], sizeof(newValue) );
-        output.verbose(CALL_INFO, 8, 0, "Response to a read, payload=%" PRId64 ", for reg: %" PRIu8 "\n", newValue, regTarget);
-        regFile->writeReg(regTarget, newValue);
+            memcpy( (void*) &newValue, &ev->data[ static_cast<size_t>(i) * 8 ], sizeof(newValue) );
+
+            JUNO_VERBOSE(output, 8, "Response to a read, payload=%" PRId64 ", for reg: %" PRIu8 "\n", newValue, regTarget);
+            respRegs->writeReg(regTarget, newValue);
+        }
     }
 
-    ldStUnit->removeEntry( ev->id );
+    respUnit->removeEntry( ev->id );
 
     // Need to clean up the events coming back from the cache
     delete ev;
-    output.verbose(CALL_INFO, 4, 0, "Complete cache response handling.\n");
+    JUNO_VERBOSE(output, 4, "Complete cache response handling.\n");
+
+    // Any response may clear the register or load slot issue is waiting on
+    if( clockGated && gatedOnMemory ) {
+	ungateClock();
+    }
+}
+
+void JunoCPU::handleWake( SST::Event* ev ) {
+    delete ev;
+
+    if( clockGated ) {
+	ungateClock();
+    }
+}
+
+void JunoCPU::handlerComplete( JunoCustomInstructionHandler* handler, const bool released ) {
+    JUNO_VERBOSE(output, 4, "Custom instruction handler completed a request.\n");
+    handlerRequests--;
+
+    if( released ) {
+	handlersWaiting--;
+
+	for( size_t t = 0; t < threads.size(); ++t ) {
+	    if( handler == threads[t].waitingOn ) {
+		threads[t].waitingOn = NULL;
+	    }
+	}
+    }
+
+    // Issue may be waiting on the handler or on a register it just wrote
+    if( clockGated ) {
+	ungateClock();
+    }
+}
+
+void JunoCPU::gateClock( const SST::Cycle_t currentCycle, const bool onMemory ) {
+    JUNO_VERBOSE(output, 16, "Core stalled, gating clock at cycle %" PRIu64 "\n",
+	static_cast<uint64_t>(currentCycle));
+
+    clockGated    = true;
+    gatedOnMemory = onMemory;
+    gatedCycle    = currentCycle;
+    gatedAccounted = 0;
+}
+
+void JunoCPU::ungateClock() {
+    const SST::Cycle_t nextCycle = reregisterClock( cpuClockTC, cpuClockHandler );
+    const SST::Cycle_t skipped   = nextCycle - gatedCycle - 1;
+
+    JUNO_VERBOSE(output, 16, "Clock restarts at cycle %" PRIu64 " (%" PRIu64 " cycles gated)\n",
+	static_cast<uint64_t>(nextCycle), static_cast<uint64_t>(skipped));
+
+    // Account for the ticks we did not take so statistics match an
+    // ungated clock, less any a statistics flush already counted
+    const SST::Cycle_t unaccounted = skipped - std::min( skipped, gatedAccounted );
+
+    accountGatedCycles( unaccounted );
+    instCyclesLeft -= std::min( instCyclesLeft, skipped );
+
+    for( size_t t = 0; t < threads.size(); ++t ) {
+	threads[t].cyclesLeft -= std::min( threads[t].cyclesLeft, skipped );
+    }
+
+    clockGated = false;
+}
+
+// Cycles skipped while gated count as if the core had ticked through them
+// in the state it gated in
+void JunoCPU::accountGatedCycles( const SST::Cycle_t cycles ) {
+    counters.cycles += cycles;
+
+    if( gatedOnMemory ) {
+	counters.scoreboardStalls += cycles;
+    }
+
+    for( size_t t = 0; t < threads.size(); ++t ) {
+	if( threads[t].stalled ) {
+	    threads[t].stallCycles      += cycles;
+	    threads[t].stallCyclesTotal += cycles;
+	}
+    }
 }
 
 void JunoCPU::init( unsigned int phase ) {
     mem->init( phase );
 
     if( 0 == phase ) {
-        const size_t initLen = static_cast<size_t>( progReader->getDataLength() + progReader->getInstLength() );
+        output.verbose(CALL_INFO, 1, 0, "Sending initialization data to memory...\n");
 
-        std::vector<uint8_t> exeImage;
-        exeImage.reserve( initLen );
+        // Only the initialized extents are sent, memory starts zeroed so
+        // BSS and padding need no transfer
+        uint64_t requests = 0;
 
-        for( size_t i = 0; i < initLen; ++i ) {
-            exeImage.push_back( progReader->getBinaryBuffer()[i] );
-        }
+        for( size_t i = 0; i < progReader->getExtentCount(); ++i ) {
+            const JunoProgramExtent& extent = progReader->getExtent( i );
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>( extent.bytes );
 
-	for( size_t i = 0; i < progReader->getPadding(); ++i ) {
-	    exeImage.push_back( static_cast<uint8_t>(0) );
-	}
+            for( uint64_t offset = 0; offset < extent.length; offset += initChunkSize ) {
+                const uint64_t chunkLen = std::min( initChunkSize, extent.length - offset );
 
-        SimpleMem::Request* writeExe = new SimpleMem::Request(SimpleMem::Request::Write, 0, exeImage.size(), exeImage);
-        output.verbose(CALL_INFO, 1, 0, "Sending initialization data to memory...\n");
+                SimpleMem::Request* writeExe = new SimpleMem::Request(SimpleMem::Request::Write,
+                    extent.addr + offset, chunkLen);
+                writeExe->data.assign( bytes + offset, bytes + offset + chunkLen );
 
-        mem->sendInitData(writeExe);
+                mem->sendInitData(writeExe);
+                requests++;
+            }
+        }
 
-        output.verbose(CALL_INFO, 1, 0, "Initialization data sent.\n");
+        output.verbose(CALL_INFO, 1, 0, "Initialization data sent in %" PRIu64 " requests.\n", requests);
     }
 }
 
@@ -207,173 +839,894 @@ void JunoCPU::setup() {
 }
 
 void JunoCPU::finish() {
+    flushStatistics();
+
+    if( threads.size() > 1 ) {
+	reportThreads();
+    }
+
+    if( samplingEnabled ) {
+	if( ! fastForwarding ) {
+	    closeSampleWindow( static_cast<SST::Cycle_t>( getCurrentSimTime( cpuClockTC ) ) );
+	}
+
+	reportSampling();
+    }
 }
 
-bool JunoCPU::clockTick( SST::Cycle_t currentCycle ) {
+// Push the local counters into the SST statistics, counts of one are
+// added as (n x 1) so sums and counts match per-event addData(1) calls
+void JunoCPU::flushStatistics() {
+    statCycles->addDataNTimes( counters.cycles, 1 );
+    statInstructions->addDataNTimes( counters.instructions, 1 );
+    statFFInstructions->addDataNTimes( counters.ffInstructions, 1 );
+    statScoreboardStalls->addDataNTimes( counters.scoreboardStalls, 1 );
+    statFUStalls->addDataNTimes( counters.fuStalls, 1 );
+
+    for( int width = 1; width <= JUNO_MAX_ISSUE_WIDTH; ++width ) {
+	statIssueGroupSize->addDataNTimes( counters.issueGroups[width], static_cast<uint64_t>(width) );
+    }
 
-    statCycles->addData(1);
-    output.verbose(CALL_INFO, 8, 0, "Cycle: %" PRIu64 "\n", static_cast<uint64_t>(currentCycle));
+    for( size_t t = 0; t < threads.size(); ++t ) {
+	if( NULL != threads[t].statInstructions ) {
+	    threads[t].statInstructions->addDataNTimes( threads[t].instructions, 1 );
+	    threads[t].statStallCycles->addDataNTimes( threads[t].stallCycles, 1 );
+	}
 
-    bool handlersClear = true;
+	threads[t].instructions = 0;
+	threads[t].stallCycles  = 0;
+    }
 
-    if( handlerCount > 0 ) {
-	    for( int i = 0; i < handlerCount; ++i ) {
-		if( customHandlers[i]->isBusy() ) {
-			handlersClear = false;
-			break;
+    for( int op = 0; op < 256; ++op ) {
+	if( counters.opCounts[op] > 0 && NULL != dispatchTable[op].opStat ) {
+	    dispatchTable[op].opStat->addDataNTimes( counters.opCounts[op], 1 );
+	}
+    }
+
+    counters.clear();
+}
+
+bool JunoCPU::handleStatFlush( SST::Cycle_t currentCycle ) {
+    // Cycles the core has skipped so far while gated belong to this period
+    if( clockGated ) {
+	const SST::Cycle_t now = static_cast<SST::Cycle_t>( getCurrentSimTime( cpuClockTC ) );
+
+	if( now > gatedCycle + gatedAccounted ) {
+	    const SST::Cycle_t newlySkipped = (now - gatedCycle) - gatedAccounted;
+
+	    accountGatedCycles( newlySkipped );
+	    gatedAccounted += newlySkipped;
+	}
+    }
+
+    flushStatistics();
+    return false;
+}
+
+bool JunoCPU::updateSampling( const SST::Cycle_t currentCycle ) {
+    if( ! fastForwarding ) {
+	if( (0 == sampleLength) || (windowInsts < sampleLength) ) {
+	    return true;
+	}
+
+	closeSampleWindow( currentCycle );
+
+	fastForwarding = true;
+	ffInstLeft = (sampleInterval > 0) ? (sampleInterval - sampleLength) :
+		std::numeric_limits<uint64_t>::max();
+
+	output.verbose(CALL_INFO, 1, 0, "Sample window done at cycle %" PRIu64 ", fast-forwarding\n",
+		static_cast<uint64_t>(currentCycle));
+    }
+
+    // Functional execution reads registers and the shadow image directly,
+    // let in-flight loads and handler requests land and buffered stores
+    // drain first
+    if( operationsPending() ) {
+	ldStUnit->flushStores();
+	return false;
+    }
+
+    if( ! ffPushed ) {
+	const bool issueTimed = fastForward();
+
+	// Stopped on a handler request, carry on once it completes
+	if( ffInstLeft > 0 && ! issueTimed ) {
+	    return false;
+	}
+
+	pushShadowState();
+	ffPushed = true;
+    }
+
+    // Detailed loads read memory, the fast-forwarded stores must be there
+    if( ! ffBulkRequests.empty() ) {
+	return false;
+    }
+
+    ffPushed = false;
+
+    if( 0 == ffInstLeft ) {
+	output.verbose(CALL_INFO, 1, 0, "Fast-forward done, detailed simulation from cycle %" PRIu64 ", PC=%" PRIu64 "\n",
+		static_cast<uint64_t>(currentCycle), pc);
+
+	fastForwarding   = false;
+	windowInsts      = 0;
+	windowStartCycle = currentCycle;
+    }
+
+    return true;
+}
+
+bool JunoCPU::canIssue( const JunoCPUInstruction* inst, const JunoDispatchEntry& entry ) {
+    // Stores are always checked, the store buffer may have to write out a
+    // line to make room even when nothing is in flight
+    if( ! operationsPending() && JUNO_DISPATCH_STORE != entry.kind && JUNO_DISPATCH_VSTORE != entry.kind ) {
+	return true;
+    }
+
+    switch( entry.kind ) {
+    case JUNO_DISPATCH_NOOP:
+	return true;
+    case JUNO_DISPATCH_LOAD:
+	return ! regFile->isPending( inst->getReadReg1() ) && ! regFile->isPending( inst->getWriteReg() ) &&
+		ldStUnit->canIssueLoad( static_cast<uint64_t>( regFile->readReg( inst->getReadReg1() ) ) );
+    case JUNO_DISPATCH_LOAD_ADDR:
+	return ! regFile->isPending( inst->getWriteReg() ) &&
+		ldStUnit->canIssueLoad( static_cast<uint64_t>( inst->get16bAbsAddr() ) );
+    case JUNO_DISPATCH_STORE:
+	return ! regFile->isPending( inst->getReadReg1() ) && ! regFile->isPending( inst->getReadReg2() ) &&
+		ldStUnit->canIssueStore( static_cast<uint64_t>( regFile->readReg( inst->getReadReg2() ) ) );
+    case JUNO_DISPATCH_VLOAD:
+	return ! regFile->isPending( inst->getReadReg1() ) && ! regFile->isPending( inst->getWriteReg(), inst->getReadReg2() ) &&
+		ldStUnit->canIssueLoad( static_cast<uint64_t>( regFile->readReg( inst->getReadReg1() ) ),
+			static_cast<uint64_t>( inst->getReadReg2() ) * 8 );
+    case JUNO_DISPATCH_VGATHER:
+	return ! regFile->isPending( inst->getReadReg1(), inst->getReadReg2() ) &&
+		! regFile->isPending( inst->getWriteReg(), inst->getReadReg2() ) &&
+		ldStUnit->canIssueGather( inst->getReadReg1(), inst->getReadReg2() );
+    case JUNO_DISPATCH_VSTORE:
+	return ! regFile->isPending( inst->getReadReg1() ) && ! regFile->isPending( inst->getWriteReg(), inst->getReadReg2() ) &&
+		ldStUnit->canIssueStore( static_cast<uint64_t>( regFile->readReg( inst->getReadReg1() ) ),
+			static_cast<uint64_t>( inst->getReadReg2() ) * 8 );
+    case JUNO_DISPATCH_JUMP_ZERO:
+    case JUNO_DISPATCH_JUMP_LTZ:
+    case JUNO_DISPATCH_JUMP_GTZ:
+	return ! regFile->isPending( inst->getReadReg1() );
+    case JUNO_DISPATCH_CUSTOM:
+	// Custom handlers may touch any register, wait for loads to land.
+	// Buffered stores can stay, handler memory traffic goes through the
+	// same load/store unit. Outstanding handler requests only hold back
+	// the registers they will write.
+	return ! ldStUnit->requestsPending() &&
+		! entry.handler->awaitingCompletion() &&
+		! regFile->isPending( inst->getReadReg1() ) &&
+		! regFile->isPending( inst->getReadReg2() ) &&
+		! (0 != (entry.operands & JUNO_OPERAND_WRITE) && regFile->isPending( inst->getWriteReg() ));
+    case JUNO_DISPATCH_HALT:
+    case JUNO_DISPATCH_UNKNOWN:
+	ldStUnit->flushStores();
+	return false;
+    default:
+	// ALU operations, a pending destination is a WAW hazard with the load
+	return ! regFile->isPending( inst->getReadReg1() ) &&
+		! regFile->isPending( inst->getReadReg2() ) &&
+		! regFile->isPending( inst->getWriteReg() );
+    }
+}
+
+// Cycle at which every register the instruction reads (and the one it
+// writes, so results land in program order) is available
+SST::Cycle_t JunoCPU::operandsReadyCycle( const JunoCPUInstruction* inst, const JunoDispatchEntry& entry ) const {
+    SST::Cycle_t ready = 0;
+
+    if( junoIsVector( entry.kind ) ) {
+	const uint8_t count = inst->getReadReg2();
+	ready = regReadyCycle[ inst->getReadReg1() ];
+
+	for( uint8_t i = 0; i < count; ++i ) {
+	    ready = std::max( ready, regReadyCycle[ inst->getWriteReg() + i ] );
+
+	    if( JUNO_DISPATCH_VGATHER == entry.kind ) {
+		ready = std::max( ready, regReadyCycle[ inst->getReadReg1() + i ] );
+	    }
+	}
+
+	return ready;
+    }
+
+    if( 0 != (entry.operands & JUNO_OPERAND_READ1) ) {
+	ready = std::max( ready, regReadyCycle[ inst->getReadReg1() ] );
+    }
+
+    if( 0 != (entry.operands & JUNO_OPERAND_READ2) ) {
+	ready = std::max( ready, regReadyCycle[ inst->getReadReg2() ] );
+    }
+
+    if( 0 != (entry.operands & JUNO_OPERAND_WRITE) ) {
+	ready = std::max( ready, regReadyCycle[ inst->getWriteReg() ] );
+    }
+
+    return ready;
+}
+
+// In-order multi-issue, up to issueWidth instructions in program order.
+// The group ends at the first instruction which has to wait, after a jump
+// (the next PC is only known once it executes) and after a custom
+// instruction (its handler may stall the core). Returns true on HALT.
+bool JunoCPU::issueGroup( const SST::Cycle_t currentCycle, bool& memoryStall, SST::Cycle_t& wakeCycle ) {
+    uint32_t issued = 0;
+
+    while( issued < issueWidth && instMgr->instReady( pc ) ) {
+	const JunoCPUInstruction* nextInst = &instMgr->getInstruction( pc );
+	const uint8_t nextInstOp = nextInst->getInstCode();
+	const JunoDispatchEntry& entry = dispatchTable[nextInstOp];
+
+	if( ! canIssue( nextInst, entry ) ) {
+	    memoryStall = (0 == issued);
+	    break;
+	}
+
+	const SST::Cycle_t readyAt = operandsReadyCycle( nextInst, entry );
+
+	if( readyAt > currentCycle ) {
+	    wakeCycle = (0 == issued) ? readyAt : 0;
+	    break;
+	}
+
+	const JunoUnitClass unitClass = junoUnitFor( entry.kind );
+	int unit = -1;
+
+	if( JUNO_UNIT_NONE != unitClass ) {
+	    unit = unitPools[unitClass].findFree( currentCycle );
+
+	    if( unit < 0 ) {
+		counters.fuStalls++;
+		wakeCycle = (0 == issued) ? unitPools[unitClass].nextFree() : 0;
+		break;
+	    }
+	}
+
+	JUNO_VERBOSE(output, 2, "Issue slot %" PRIu32 ", PC=%" PRIu64 ", operation code: %" PRIu8 "\n", issued, pc, nextInstOp);
+
+	regFile->syncPC();
+	counters.instructions++;
+
+	if( samplingEnabled ) {
+	    windowInsts++;
+	    detailedInstTotal++;
+	}
+
+	if( entry.execute( this, nextInst ) ) {
+	    return true;
+	}
+
+	if( entry.advancePC ) {
+	    pc += 4;
+	}
+
+	SST::Cycle_t latency = entry.cycles;
+
+	if( NULL != entry.handler ) {
+	    latency = entry.handler->takeBusyCycles();
+	}
+
+	latency = std::max( latency, static_cast<SST::Cycle_t>(1) );
+
+	// ALU and load/store units accept a new operation every cycle, the
+	// others are held for the whole operation
+	if( unit >= 0 ) {
+	    const bool pipelined = (JUNO_UNIT_ALU == unitClass) || (JUNO_UNIT_LSU == unitClass);
+	    unitPools[unitClass].reserve( unit, currentCycle + (pipelined ? 1 : latency) );
+	}
+
+	if( 0 != (entry.operands & JUNO_OPERAND_WRITE) ) {
+	    regReadyCycle[ nextInst->getWriteReg() ] = currentCycle + latency;
+	}
+
+	counters.opCounts[nextInstOp]++;
+
+	if( JUNO_DISPATCH_LOAD == entry.kind || JUNO_DISPATCH_LOAD_ADDR == entry.kind ||
+	    JUNO_DISPATCH_VLOAD == entry.kind || JUNO_DISPATCH_VGATHER == entry.kind ) {
+	    statLoadMLP->addData( ldStUnit->loadsPending() );
+	}
+
+	issued++;
+
+	if( JUNO_DISPATCH_JUMP_ZERO == entry.kind || JUNO_DISPATCH_JUMP_LTZ == entry.kind ||
+	    JUNO_DISPATCH_JUMP_GTZ == entry.kind || JUNO_DISPATCH_CUSTOM == entry.kind ) {
+	    break;
+	}
+    }
+
+    counters.issueGroups[issued]++;
+    return false;
+}
+
+void JunoCPU::switchThread( const uint32_t thread ) {
+    if( thread == activeThread ) {
+	return;
+    }
+
+    threads[activeThread].pc = pc;
+
+    activeThread = thread;
+    pc           = threads[thread].pc;
+    regFile      = threads[thread].regFile;
+    ldStUnit     = threads[thread].ldStUnit;
+}
+
+// True once no thread has a load or store waiting on memory
+bool JunoCPU::threadsDrained() const {
+    for( size_t t = 0; t < threads.size(); ++t ) {
+	if( threads[t].ldStUnit->requestsPending() ) {
+	    return false;
+	}
+    }
+
+    return true;
+}
+
+// Fine grained multithreading, one instruction issues each cycle from a
+// thread picked by the fetch policy. A thread waiting on a pending
+// register, the memory system or a handler, or busy with a multi-cycle
+// operation, leaves the cycle to the others. Returns true once every
+// thread has halted or the clock is gated.
+bool JunoCPU::clockThreads( const SST::Cycle_t currentCycle ) {
+    const uint32_t threadCount = static_cast<uint32_t>( threads.size() );
+    int chosen = -1;
+    uint32_t chosenLoads = 0;
+    bool memoryStall = false;
+    // A stalled thread might issue next cycle without any event arriving
+    bool retryNextCycle = false;
+
+    for( uint32_t i = 0; i < threadCount; ++i ) {
+	const uint32_t t = (lastIssuedThread + 1 + i) % threadCount;
+	JunoHardwareThread& thread = threads[t];
+
+	thread.stalled = false;
+
+	if( thread.halted || thread.cyclesLeft > 0 ) {
+	    continue;
+	}
+
+	if( NULL != thread.waitingOn ) {
+	    thread.stalled = true;
+	    continue;
+	}
+
+	switchThread( t );
+	regFile->syncPC();
+
+	if( ! instMgr->instReady( pc ) ) {
+	    retryNextCycle = true;
+	    continue;
+	}
+
+	const JunoCPUInstruction* nextInst = &instMgr->getInstruction( pc );
+	const JunoDispatchEntry& entry = dispatchTable[ nextInst->getInstCode() ];
+
+	// A thread halts straight away, only the last one waits for the
+	// memory system to drain before ending the simulation
+	const bool lastHalt = (JUNO_DISPATCH_HALT == entry.kind) && (1 == liveThreads);
+
+	if( (JUNO_DISPATCH_HALT != entry.kind || lastHalt) &&
+		! (canIssue( nextInst, entry ) && (! lastHalt || threadsDrained())) ) {
+
+	    thread.stalled = true;
+	    memoryStall    = true;
+	    retryNextCycle = retryNextCycle || ldStUnit->stallMakesProgress();
+	    continue;
+	}
+
+	if( chosen < 0 || (JUNO_FETCH_ICOUNT == fetchPolicy && ldStUnit->loadsPending() < chosenLoads) ) {
+	    chosen      = static_cast<int>(t);
+	    chosenLoads = ldStUnit->loadsPending();
+	}
+    }
+
+    if( chosen >= 0 ) {
+	JunoHardwareThread& thread = threads[chosen];
+
+	switchThread( static_cast<uint32_t>(chosen) );
+	regFile->syncPC();
+
+	const JunoCPUInstruction* nextInst = &instMgr->getInstruction( pc );
+	const uint8_t nextInstOp = nextInst->getInstCode();
+	const JunoDispatchEntry& entry = dispatchTable[nextInstOp];
+
+	JUNO_VERBOSE(output, 2, "Thread %d, PC=%" PRIu64 ", operation code: %" PRIu8 "\n", chosen, pc, nextInstOp);
+
+	lastIssuedThread = static_cast<uint32_t>(chosen);
+	counters.instructions++;
+	thread.instructions++;
+	thread.instructionsTotal++;
+
+	if( JUNO_DISPATCH_HALT == entry.kind && liveThreads > 1 ) {
+	    JUNO_VERBOSE(output, 2, "Thread %d halted, %" PRIu32 " threads still running\n", chosen, liveThreads - 1);
+	    thread.halted = true;
+	    liveThreads--;
+	} else {
+	    if( entry.execute( this, nextInst ) ) {
+		return true;
+	    }
+
+	    if( entry.advancePC ) {
+		pc += 4;
+	    }
+
+	    thread.cyclesLeft = entry.cycles;
+
+	    if( NULL != entry.handler ) {
+		thread.cyclesLeft = entry.handler->takeBusyCycles();
+
+		if( entry.handler->awaitingCompletion() ) {
+		    thread.waitingOn = entry.handler;
 		}
-    	}
+	    }
+
+	    counters.opCounts[nextInstOp]++;
+
+	    if( JUNO_DISPATCH_LOAD == entry.kind || JUNO_DISPATCH_LOAD_ADDR == entry.kind ||
+	        JUNO_DISPATCH_VLOAD == entry.kind || JUNO_DISPATCH_VGATHER == entry.kind ) {
+		statLoadMLP->addData( ldStUnit->loadsPending() );
+	    }
+	}
+    } else if( memoryStall ) {
+	counters.scoreboardStalls++;
     }
 
-    if( 0 == instCyclesLeft ) {
-        if( ldStUnit->operationsPending() ) {
-            output.verbose(CALL_INFO, 16, 0, "Memory operation pending, no instructions this cycle.\n");
-	} else if( ! handlersClear ) {
-	    output.verbose(CALL_INFO, 2, 0, "Handlers are still busy, no instructions this cycle.\n");
-        } else if( instMgr->instReady( pc ) ) {
-            output.verbose(CALL_INFO, 2, 0, "Next Instruction, PC=%" PRId64 "...\n", pc);
-
-	    if( output.getVerboseLevel() >= 32 ) {
-		regFile->printRegisters();
+    // Stop the clock when no thread can issue next cycle, busy threads wake
+    // it through the link and stalled ones through their response
+    bool gate = ! retryNextCycle;
+    bool onMemory = false;
+    SST::Cycle_t wakeIn = std::numeric_limits<SST::Cycle_t>::max();
+
+    for( uint32_t t = 0; t < threadCount; ++t ) {
+	JunoHardwareThread& thread = threads[t];
+
+	if( thread.halted ) {
+	    continue;
+	}
+
+	if( thread.stalled ) {
+	    thread.stallCycles++;
+	    thread.stallCyclesTotal++;
+	    onMemory = onMemory || (NULL == thread.waitingOn);
+	}
+
+	if( thread.cyclesLeft > 0 ) {
+	    thread.cyclesLeft--;
+	}
+
+	if( thread.cyclesLeft > 1 ) {
+	    wakeIn = std::min( wakeIn, thread.cyclesLeft );
+	} else if( ! thread.stalled ) {
+	    gate = false;
+	}
+    }
+
+    if( gate ) {
+	gateClock( currentCycle, onMemory );
+
+	if( wakeIn != std::numeric_limits<SST::Cycle_t>::max() ) {
+	    wakeLink->send( wakeIn - 2, new SST::NullEvent() );
+	}
+
+	return true;
+    }
+
+    return false;
+}
+
+void JunoCPU::reportThreads() {
+    const double cycles = static_cast<double>( getCurrentSimTime( cpuClockTC ) );
+
+    for( size_t t = 0; t < threads.size(); ++t ) {
+	output.output("Juno[%s] thread %d: %" PRIu64 " instructions, IPC %.4f, %" PRIu64 " stall cycles\n",
+		getName().c_str(), static_cast<int>(t), threads[t].instructionsTotal,
+		(cycles > 0) ? static_cast<double>( threads[t].instructionsTotal ) / cycles : 0.0,
+		threads[t].stallCyclesTotal);
+    }
+}
+
+void JunoCPU::closeSampleWindow( const SST::Cycle_t currentCycle ) {
+    if( windowInsts > 0 ) {
+	const double cycles = static_cast<double>( currentCycle - windowStartCycle );
+	windowCPI.push_back( cycles / static_cast<double>( windowInsts ) );
+    }
+
+    windowInsts = 0;
+}
+
+// Runs instructions without timing until ffInstLeft reaches zero, loads and
+// stores only use the shadow copy and nothing is sent to memory. Returns
+// true if the next instruction has to issue with timing.
+bool JunoCPU::fastForward() {
+    uint64_t executed = 0;
+    bool issueTimed = false;
+
+    while( ffInstLeft > 0 ) {
+	const JunoCPUInstruction* nextInst = &instMgr->getInstruction( pc );
+	const JunoDispatchEntry& entry = dispatchTable[ nextInst->getInstCode() ];
+
+	regFile->syncPC();
+
+	if( JUNO_DISPATCH_LOAD == entry.kind ) {
+	    const uint64_t addr = static_cast<uint64_t>( regFile->readReg( nextInst->getReadReg1() ) );
+	    ldStUnit->checkAddress( addr );
+	    warmLine( addr );
+	    regFile->writeReg( nextInst->getWriteReg(), shadowMem->read64( addr ) );
+	    pc += 4;
+	} else if( JUNO_DISPATCH_LOAD_ADDR == entry.kind ) {
+	    const uint64_t addr = static_cast<uint64_t>( nextInst->get16bAbsAddr() );
+	    warmLine( addr );
+	    regFile->writeReg( nextInst->getWriteReg(), shadowMem->read64( addr ) );
+	    pc += 4;
+	} else if( JUNO_DISPATCH_STORE == entry.kind ) {
+	    const uint64_t addr = static_cast<uint64_t>( regFile->readReg( nextInst->getReadReg2() ) );
+
+	    ldStUnit->checkAddress( addr );
+	    recordStore( addr, regFile->readReg( nextInst->getReadReg1() ) );
+	    pc += 4;
+	} else if( JUNO_DISPATCH_VLOAD == entry.kind || JUNO_DISPATCH_VGATHER == entry.kind ) {
+	    const uint64_t base = static_cast<uint64_t>( regFile->readReg( nextInst->getReadReg1() ) );
+
+	    for( uint8_t i = 0; i < nextInst->getReadReg2(); ++i ) {
+		const uint64_t addr = (JUNO_DISPATCH_VLOAD == entry.kind) ? (base + static_cast<uint64_t>(i) * 8) :
+			static_cast<uint64_t>( regFile->readReg( nextInst->getReadReg1() + i ) );
+
+		ldStUnit->checkAddress( addr );
+		warmLine( addr );
+		regFile->writeReg( nextInst->getWriteReg() + i, shadowMem->read64( addr ) );
 	    }
 
-            JunoCPUInstruction* nextInst = instMgr->getInstruction( pc );
-            const uint8_t nextInstOp = nextInst->getInstCode();
+	    pc += 4;
+	} else if( JUNO_DISPATCH_VSTORE == entry.kind ) {
+	    const uint64_t base = static_cast<uint64_t>( regFile->readReg( nextInst->getReadReg1() ) );
 
-            output.verbose(CALL_INFO, 4, 0, "Operation code: %" PRIu8 "\n", nextInstOp);
-	    statInstructions->addData(1);
+	    for( uint8_t i = 0; i < nextInst->getReadReg2(); ++i ) {
+		const uint64_t addr = base + static_cast<uint64_t>(i) * 8;
 
-            switch( nextInstOp ) {
-                case JUNO_LOAD :
-                    executeLoad( output, nextInst, regFile, ldStUnit );
-		    statMemReads->addData(1);
-                    pc += 4;
-                    break;
+		ldStUnit->checkAddress( addr );
+		recordStore( addr, regFile->readReg( nextInst->getWriteReg() + i ) );
+	    }
 
-                case JUNO_LOAD_ADDR:
-                    executeLDA( output, nextInst, regFile, ldStUnit );
-		    statMemReads->addData(1);
-                    pc += 4;
-                    break;
+	    pc += 4;
+	} else if( JUNO_DISPATCH_CUSTOM == entry.kind ) {
+	    // The handler's latency is dropped. A handler which started a
+	    // request answers through its links, wait for it before going on.
+	    dispatchCustom( this, nextInst );
+	    entry.handler->takeBusyCycles();
 
-                case JUNO_STORE :
-                    executeStore( output, nextInst, regFile, ldStUnit );
-		    statMemWrites->addData(1);
-                    pc += 4;
-                    break;
+	    ffInstLeft--;
+	    executed++;
 
-                case JUNO_ADD :
-                    executeAdd( output, nextInst, regFile );
-                    pc += 4;
-                    instCyclesLeft = addCycles;
-		    statAddIns->addData(1);
-                    break;
+	    if( operationsPending() ) {
+		break;
+	    }
 
-                case JUNO_SUB :
-                    executeSub( output, nextInst, regFile );
-                    pc += 4;
-                    instCyclesLeft = subCycles;
-		    statSubIns->addData(1);
-                    break;
+	    continue;
+	} else if( JUNO_DISPATCH_HALT == entry.kind || JUNO_DISPATCH_UNKNOWN == entry.kind ) {
+	    // HALT has to stop the clock, always issued with timing
+	    issueTimed = true;
+	    break;
+	} else {
+	    entry.execute( this, nextInst );
 
-                case JUNO_MUL :
-                    executeMul( output, nextInst, regFile );
-                    pc += 4;
-                    instCyclesLeft = mulCycles;
-		    statMulIns->addData(1);
-                    break;
+	    if( entry.advancePC ) {
+		pc += 4;
+	    }
+	}
 
-                case JUNO_AND :
-                    executeAnd( output, nextInst, regFile );
-                    pc += 4;
-                    instCyclesLeft = andCycles;
-		    statAndIns->addData(1);
-                    break;
+	ffInstLeft--;
+	executed++;
+    }
 
-                case JUNO_OR :
-                    executeOr( output, nextInst, regFile );
-                    pc += 4;
-                    instCyclesLeft = subCycles;
-		    statOrIns->addData(1);
-                    break;
+    regFile->syncPC();
 
-                case JUNO_XOR :
-                    executeXor( output, nextInst, regFile );
-                    pc += 4;
-                    instCyclesLeft = xorCycles;
-		    statXorIns->addData(1);
-                    break;
+    if( executed > 0 ) {
+	ffInstTotal += executed;
+	counters.ffInstructions += executed;
+    }
 
-                case JUNO_NOT :
-		    executeNot( output, nextInst, regFile );
-                    pc += 4;
-		    instCyclesLeft = notCycles;
-		    statNotIns->addData(1);
-                    break;
+    return issueTimed;
+}
 
-                case JUNO_PCR_JUMP_ZERO:
-                    executeJumpZero( output, nextInst, regFile, &pc );
-                    break;
+// Remember the lines fast-forwarded loads touch, the most recent
+// fastforward-warm-lines of them are read when detailed simulation starts
+void JunoCPU::warmLine( const uint64_t addr ) {
+    const uint64_t line = addr / ffLineBytes;
 
-                case JUNO_PCR_JUMP_LTZ:
-                    executeJumpLTZ( output, nextInst, regFile, &pc );
-                    break;
+    if( line == ffLastLine || ffWarmLines.empty() ) {
+	return;
+    }
 
-                case JUNO_PCR_JUMP_GTZ:
-                    executeJumpGTZ( output, nextInst, regFile, &pc );
-                    break;
+    ffLastLine = line;
+    ffWarmLines[ffWarmNext] = line * ffLineBytes;
+    ffWarmNext = (ffWarmNext + 1 == ffWarmLines.size()) ? 0 : (ffWarmNext + 1);
+    ffWarmUsed = std::min( ffWarmUsed + 1, ffWarmLines.size() );
+}
 
-                case JUNO_MOD :
-                    executeMod( output, nextInst, regFile );
-                    pc += 4;
-                    instCyclesLeft = modCycles;
-		    statModIns->addData(1);
-                    break;
+// Bring memory and the caches up to date with fast-forward in one step. Every
+// run of stored bytes is written from the shadow copy and the remembered load
+// lines which were not written are read, all sent together and none of them
+// timed against a sample window.
+void JunoCPU::pushShadowState() {
+    ffDirtyRuns.clear();
+    ffScratchLines.clear();
+    shadowMem->takeDirtyRuns( ffLineBytes, ffDirtyRuns );
 
-                case JUNO_DIV :
-                    executeDiv( output, nextInst, regFile );
-                    pc += 4;
-                    instCyclesLeft = divCycles;
-		    statDivIns->addData(1);
-                    break;
+    for( size_t i = 0; i < ffDirtyRuns.size(); ++i ) {
+	const JunoShadowRun& run = ffDirtyRuns[i];
+	std::vector<uint8_t> payload( run.length );
 
-                case JUNO_NOOP :
-                    pc += 4;
-                    instCyclesLeft = 1;
-                    break;
+	shadowMem->read( run.addr, &payload[0], run.length );
+
+	SimpleMem::Request* req = new SimpleMem::Request( SimpleMem::Request::Write, run.addr, run.length, payload );
+	ffBulkRequests.insert( req->id );
+	mem->sendRequest( req );
+
+	ffScratchLines.push_back( (run.addr / ffLineBytes) * ffLineBytes );
+    }
+
+    const size_t written = ffScratchLines.size();
+    ffScratchLines.insert( ffScratchLines.end(), ffWarmLines.begin(), ffWarmLines.begin() + ffWarmUsed );
+
+    // Written lines are in the caches already, read each other line once
+    std::sort( ffScratchLines.begin(), ffScratchLines.begin() + written );
+    std::sort( ffScratchLines.begin() + written, ffScratchLines.end() );
+
+    uint64_t reads = 0;
+
+    for( size_t i = written; i < ffScratchLines.size(); ++i ) {
+	if( (i > written && ffScratchLines[i] == ffScratchLines[i - 1]) ||
+	    std::binary_search( ffScratchLines.begin(), ffScratchLines.begin() + written, ffScratchLines[i] ) ) {
+	    continue;
+	}
+
+	SimpleMem::Request* req = new SimpleMem::Request( SimpleMem::Request::Read, ffScratchLines[i], 8 );
+	ffBulkRequests.insert( req->id );
+	mem->sendRequest( req );
+	reads++;
+    }
+
+    JUNO_VERBOSE(output, 2, "Fast-forward state pushed to memory: %" PRIu64 " writes, %" PRIu64 " warming reads\n",
+	static_cast<uint64_t>( ffDirtyRuns.size() ), reads);
+
+    ffWarmNext = 0;
+    ffWarmUsed = 0;
+    ffLastLine = UINT64_MAX;
+}
+
+// Two-sided 95% critical value of Student's t distribution
+static double studentT95( const uint64_t dof ) {
+    static const double table[] = {
+	12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+	2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+
+    // Past the table use the value at the start of each range, it is
+    // slightly wide rather than narrow
+    if( dof <= 30 ) {
+	return table[dof - 1];
+    } else if( dof <= 40 ) {
+	return 2.042;
+    } else if( dof <= 60 ) {
+	return 2.021;
+    } else if( dof <= 120 ) {
+	return 2.000;
+    }
+
+    return 1.980;
+}
+
+void JunoCPU::reportSampling() {
+    const uint64_t totalInsts = ffInstTotal + detailedInstTotal;
+    const double windows = static_cast<double>( windowCPI.size() );
+
+    output.output("Juno[%s] sampling: %" PRIu64 " instructions (%" PRIu64 " fast-forwarded, %" PRIu64 " detailed) in %" PRIu64 " windows\n",
+	getName().c_str(), totalInsts, ffInstTotal, detailedInstTotal, static_cast<uint64_t>(windowCPI.size()));
+
+    if( windowCPI.empty() ) {
+	return;
+    }
+
+    double meanCPI = 0;
+
+    for( size_t i = 0; i < windowCPI.size(); ++i ) {
+	meanCPI += windowCPI[i];
+    }
 
-                case JUNO_HALT :
-                    primaryComponentOKToEndSim();
+    meanCPI /= windows;
+
+    const double estCycles = meanCPI * static_cast<double>( totalInsts );
+
+    if( windowCPI.size() < 2 ) {
+	output.output("Juno[%s] sampling: CPI %.4f, estimated %.0f cycles (one window, no confidence bound)\n",
+		getName().c_str(), meanCPI, estCycles);
+	return;
+    }
+
+    double variance = 0;
+
+    for( size_t i = 0; i < windowCPI.size(); ++i ) {
+	variance += (windowCPI[i] - meanCPI) * (windowCPI[i] - meanCPI);
+    }
+
+    variance /= (windows - 1.0);
+
+    // 95% confidence interval on the mean CPI, Student's t as the
+    // variance comes from the windows themselves
+    const double halfWidth = studentT95( windowCPI.size() - 1 ) * std::sqrt( variance / windows );
+
+    output.output("Juno[%s] sampling: CPI %.4f +/- %.4f (95%% confidence, %" PRIu64 " windows), estimated %.0f cycles [%.0f, %.0f]\n",
+	getName().c_str(), meanCPI, halfWidth, static_cast<uint64_t>( windowCPI.size() ), estCycles,
+	(meanCPI - halfWidth) * static_cast<double>( totalInsts ),
+	(meanCPI + halfWidth) * static_cast<double>( totalInsts ));
+}
+
+bool JunoCPU::clockTick( SST::Cycle_t currentCycle ) {
+
+    counters.cycles++;
+    JUNO_VERBOSE(output, 8, "Cycle: %" PRIu64 "\n", static_cast<uint64_t>(currentCycle));
+
+    if( threads.size() > 1 ) {
+	return clockThreads( currentCycle );
+    }
+
+    bool memoryStall  = false;
+    bool handlerStall = false;
+    SST::Cycle_t wakeCycle = 0;
+
+    if( 0 == instCyclesLeft ) {
+	// r0 mirrors the PC of the instruction about to issue
+	regFile->syncPC();
+
+	if( handlersWaiting > 0 ) {
+	    JUNO_VERBOSE(output, 2, "Handlers are still busy, no instructions this cycle.\n");
+	    handlerStall = true;
+	} else if( samplingEnabled && ! updateSampling( currentCycle ) ) {
+            JUNO_VERBOSE(output, 16, "Memory operation pending before fast-forward, no instructions this cycle.\n");
+	    memoryStall = true;
+        } else if( issueWidth > 1 ) {
+	    if( issueGroup( currentCycle, memoryStall, wakeCycle ) ) {
+		return true;
+	    }
+        } else if( ! instMgr->instReady( pc ) ) {
+            JUNO_VERBOSE(output, 16, "Instruction at PC=%" PRIu64 " not ready, no instructions this cycle.\n", pc);
+        } else if( ! canIssue( &instMgr->getInstruction( pc ),
+		dispatchTable[ instMgr->getInstruction( pc ).getInstCode() ] ) ) {
+            JUNO_VERBOSE(output, 16, "Waiting on a pending register or memory operation, no instructions this cycle.\n");
+	    memoryStall = true;
+        } else {
+            JUNO_VERBOSE(output, 2, "Next Instruction, PC=%" PRId64 "...\n", pc);
+
+	    if( JUNO_MAX_VERBOSE >= 32 && output.getVerboseLevel() >= 32 ) {
+		regFile->printRegisters();
+	    }
+
+            // Blocks are not checked against the scoreboard so they are
+            // only used while no loads or handler requests are in flight.
+            // Buffered or outstanding stores leave no register pending.
+            const JunoBasicBlock* block = (NULL == blockCache || ldStUnit->loadsPending() > 0 || handlerRequests > 0) ?
+		NULL : &blockCache->getBlock( pc );
+
+            if( NULL != block && block->length > 1 ) {
+                executeBlock( *block );
+
+                if( samplingEnabled ) {
+                    windowInsts       += block->length;
+                    detailedInstTotal += block->length;
+                }
+            } else {
+                const JunoCPUInstruction* nextInst = &instMgr->getInstruction( pc );
+                const uint8_t nextInstOp = nextInst->getInstCode();
+
+                JUNO_VERBOSE(output, 4, "Operation code: %" PRIu8 "\n", nextInstOp);
+                counters.instructions++;
+
+                if( samplingEnabled ) {
+                    windowInsts++;
+                    detailedInstTotal++;
+                }
+
+                const JunoDispatchEntry& entry = dispatchTable[nextInstOp];
+
+#ifdef JUNO_COMPUTED_GOTO
+                // Order must match JunoDispatchKind
+                static const void* dispatchLabels[] = {
+                    &&dispatch_unknown, &&dispatch_noop, &&dispatch_halt,
+                    &&dispatch_load, &&dispatch_load_addr, &&dispatch_store,
+                    &&dispatch_vload, &&dispatch_vgather, &&dispatch_vstore,
+                    &&dispatch_add, &&dispatch_sub, &&dispatch_mul, &&dispatch_div, &&dispatch_mod,
+                    &&dispatch_and, &&dispatch_or, &&dispatch_xor, &&dispatch_not,
+                    &&dispatch_jump_zero, &&dispatch_jump_ltz, &&dispatch_jump_gtz,
+                    &&dispatch_custom
+                };
+
+                goto *dispatchLabels[entry.kind];
+
+dispatch_load:      executeLoad( output, nextInst, regFile, ldStUnit );  goto dispatch_done;
+dispatch_load_addr: executeLDA( output, nextInst, regFile, ldStUnit );   goto dispatch_done;
+dispatch_store:     dispatchStore( this, nextInst ); goto dispatch_done;
+dispatch_vload:     executeVectorLoad( output, nextInst, regFile, ldStUnit ); goto dispatch_done;
+dispatch_vgather:   executeGather( output, nextInst, regFile, ldStUnit );     goto dispatch_done;
+dispatch_vstore:    dispatchVectorStore( this, nextInst ); goto dispatch_done;
+dispatch_add:       executeAdd( output, nextInst, regFile ); goto dispatch_done;
+dispatch_sub:       executeSub( output, nextInst, regFile ); goto dispatch_done;
+dispatch_mul:       executeMul( output, nextInst, regFile ); goto dispatch_done;
+dispatch_div:       executeDiv( output, nextInst, regFile ); goto dispatch_done;
+dispatch_mod:       executeMod( output, nextInst, regFile ); goto dispatch_done;
+dispatch_and:       executeAnd( output, nextInst, regFile ); goto dispatch_done;
+dispatch_or:        executeOr( output, nextInst, regFile );  goto dispatch_done;
+dispatch_xor:       executeXor( output, nextInst, regFile ); goto dispatch_done;
+dispatch_not:       executeNot( output, nextInst, regFile ); goto dispatch_done;
+dispatch_jump_zero: executeJumpZero( output, nextInst, regFile, &pc ); goto dispatch_done;
+dispatch_jump_ltz:  executeJumpLTZ( output, nextInst, regFile, &pc );  goto dispatch_done;
+dispatch_jump_gtz:  executeJumpGTZ( output, nextInst, regFile, &pc );  goto dispatch_done;
+dispatch_noop:      goto dispatch_done;
+dispatch_halt:      return dispatchHalt( this, nextInst );
+dispatch_custom:    dispatchCustom( this, nextInst ); goto dispatch_done;
+dispatch_unknown:   dispatchUnknown( this, nextInst );
+
+dispatch_done:
+#else
+                if( entry.execute( this, nextInst ) ) {
                     return true;
+                }
+#endif
 
-                default:
-		    int instStatus = 1;
+                if( entry.advancePC ) {
+                    pc += 4;
+                }
 
-		    for( size_t i = 0; i < customHandlers.size(); ++i ) {
-			if( customHandlers[i]->canProcessInst(nextInstOp) ) {
-				instStatus = customHandlers[i]->execute( &output, nextInst,
-					regFile, ldStUnit, &pc );
-				break;
-			}
-		    }
+                instCyclesLeft = entry.cycles;
 
-		    if( instStatus != 0 ) {
-                    	fprintf(stderr, "ERROR: Unknown instruction encountered (return code %d)\n", instStatus);
-                    	exit(-1);
-		    }
+                // Handlers report their own latency from execute
+                if( NULL != entry.handler ) {
+                    instCyclesLeft = entry.handler->takeBusyCycles();
+                }
 
-                    break;
-            }
+                counters.opCounts[nextInstOp]++;
 
-	    delete nextInst;
+                if( JUNO_DISPATCH_LOAD == entry.kind || JUNO_DISPATCH_LOAD_ADDR == entry.kind ||
+                    JUNO_DISPATCH_VLOAD == entry.kind || JUNO_DISPATCH_VGATHER == entry.kind ) {
+                    statLoadMLP->addData( ldStUnit->loadsPending() );
+                }
+            }
         }
     } else {
-        output.verbose(CALL_INFO, 4, 0, "CPU still busy (%" PRIu64 " cycles to go.\n", static_cast<uint64_t>(instCyclesLeft));
+        JUNO_VERBOSE(output, 4, "CPU still busy (%" PRIu64 " cycles to go.\n", static_cast<uint64_t>(instCyclesLeft));
+    }
+
+    if( memoryStall ) {
+        counters.scoreboardStalls++;
     }
 
     if( instCyclesLeft > 0 ) {
         instCyclesLeft--;
     }
 
+    // Nothing can issue until the ALU is done, a memory response clears the
+    // stall or a handler signals completion, stop the clock until then
+    if( instCyclesLeft > 1 ) {
+	gateClock( currentCycle, false );
+
+	// Wake no later than the tick before the core is ready, the link
+	// may add up to a cycle of latency of its own
+	wakeLink->send( instCyclesLeft - 2, new SST::NullEvent() );
+	return true;
+    } else if( handlerStall || (memoryStall && ! ldStUnit->stallMakesProgress()) ) {
+	gateClock( currentCycle, memoryStall );
+	return true;
+    } else if( wakeCycle > currentCycle + 1 ) {
+	// Multi-issue waiting on an operation's latency or a busy unit
+	gateClock( currentCycle, false );
+	wakeLink->send( wakeCycle - currentCycle - 2, new SST::NullEvent() );
+	return true;
+    }
+
     return false;
 }
@@ -23,11 +23,21 @@
 
 #include <sst/core/interfaces/simpleMem.h>
 
+#include <unordered_set>
+#include <vector>
+
 #include "junoldstunit.h"
 #include "junoprogreader.h"
 #include "junoregfile.h"
 #include "junoinstmgr.h"
 #include "junocpuinst.h"
+#include "junodispatch.h"
+#include "junoblockcache.h"
+#include "junoshadowmem.h"
+#include "junoverbose.h"
+#include "junocpucounters.h"
+#include "junoissue.h"
+#include "junohwthread.h"
 
 #include "custominst/junocustinst.h"
 
@@ -37,7 +47,7 @@ using namespace SST::Juno;
 namespace SST {
     namespace Juno {
         
-        class JunoCPU : public SST::Component {
+        class JunoCPU : public SST::Component, public JunoCustomInstructionOwner {
             
         public:
             JunoCPU( SST::ComponentId_t id, SST::Params& params );
@@ -50,6 +60,8 @@ namespace SST {
             
             bool clockTick( SST::Cycle_t currentCycle );
             void handleEvent( SimpleMem::Request* ev );
+            void handleWake( SST::Event* ev );
+            void handlerComplete( JunoCustomInstructionHandler* handler, const bool released );
             
             SST_ELI_REGISTER_COMPONENT(
                                        JunoCPU,
@@ -64,7 +76,7 @@ namespace SST {
                                     { "printFrequency", "How frequently to print a message from the component", "5" },
                                     { "repeats", "Number of repetitions to make", "10" },
                                     { "program", "The assembly file to run.", "" },
-                                    { "verbose", "Sets the verbosity level of output.", "0" },
+                                    { "verbose", "Sets the verbosity level of output, per-instruction messages above JUNO_MAX_VERBOSE are compiled out", "0" },
                                     { "clock", "Clock for the CPU", "1GHz" },
                                     { "cycles-add", "Cycles to spend on an ADD operation", "1"},
                                     { "cycles-sub", "Cycles to spend on an SUB operation", "1"},
@@ -75,7 +87,26 @@ namespace SST {
                                     { "cycles-xor", "Cycles to spend on an XOR operation", "1"},
                                     { "cycles-or",  "Cycles to spend on an OR operation", "1"},
                                     { "cycles-not",  "Cycles to spend on an NOT (bit flip) operation", "1"},
-				    { "max-address", "Set a maximum address that memory addresses are allowed to access (debugging mechanism)", "2147483647" }
+				    { "max-address", "Set a maximum address that memory addresses are allowed to access (debugging mechanism)", "2147483647" },
+				    { "init-chunk-size", "Most bytes sent to memory in one initialization request, only initialized extents of the program are sent", "65536" },
+				    { "max-outstanding-loads", "Loads which may be in flight at once, instructions not waiting on a loaded register keep issuing", "1" },
+				    { "store-buffer-depth", "Cache lines the store buffer holds, stores retire into it without waiting on memory, 0 disables it, otherwise at least 64 / store-buffer-line + 1", "8" },
+				    { "store-buffer-line", "Bytes per store buffer line, adjacent stores in a line are written to memory together", "64" },
+				    { "cache-line-size", "Bytes per cache line, VLOAD/VSTORE send one request for each line their words fall in", "64" },
+				    { "stat-flush-period", "Period at which locally counted statistics are pushed to SST (always flushed at finish), defaults to the output rate of periodically dumped statistics", "" },
+				    { "block-cache", "Execute runs of ALU operations as a single basic block (timing is unchanged)", "1" },
+				    { "fastforward-instructions", "Instructions to execute functionally (no timing, no memory traffic) before detailed simulation starts, the bytes they stored are written to memory when it does", "0" },
+				    { "fastforward-warm-lines", "Cache lines most recently loaded while fast-forwarding which are read when detailed simulation starts, 0 starts with the caches as fast-forward left them", "1024" },
+				    { "sample-length", "Instructions in each detailed sampling window, 0 runs detailed to the end", "0" },
+				    { "sample-interval", "Instructions from the start of one sampling window to the start of the next, 0 takes a single window", "0" },
+				    { "issue-width", "Instructions issued in order per cycle, 1 keeps the blocking single-issue model where an operation holds the core for its cycles", "1" },
+				    { "fu-alu", "ALU units (ADD/SUB/AND/OR/XOR/NOT) when issue-width > 1, pipelined, defaults to issue-width", "" },
+				    { "fu-muldiv", "MUL/DIV/MOD units when issue-width > 1, each is busy for the whole operation", "1" },
+				    { "fu-lsu", "Load/store units when issue-width > 1, pipelined", "1" },
+				    { "fu-custom", "Custom instruction units when issue-width > 1, each is busy for the cycles the handler reports", "1" },
+				    { "hw-threads", "Hardware threads, each with its own PC and registers running the program from the start, one issues per cycle", "1" },
+				    { "fetch-policy", "Thread chosen when several can issue, round-robin or icount (fewest loads in flight)", "round-robin" },
+				    { "thread-id-register", "Register set to the thread number at start so threads can split the work, 0 for none", "0" }
                                     )
 
 	    SST_ELI_DOCUMENT_STATISTICS(
@@ -91,7 +122,17 @@ namespace SST {
 				   { "and-ins-count", "AND instructions issued by the CPU", "instructions", 1 },
 				   { "or-ins-count", "OR instructions issued by the CPU", "instructions", 1 },
 				   { "xor-ins-count", "XOR instructions issued by the CPU", "instructions", 1 },
-				   { "not-ins-count", "NOT instructions issued by the CPU", "instructions", 1 }
+				   { "not-ins-count", "NOT instructions issued by the CPU", "instructions", 1 },
+				   { "ff-instructions", "Instructions executed functionally while fast-forwarding", "instructions", 1 },
+				   { "load-mlp", "Loads in flight (including itself) each time a load is issued", "loads", 1 },
+				   { "store-buffer-writes", "Write requests sent to memory by the store buffer", "requests", 1 },
+				   { "store-buffer-combined", "Stores merged into a line already held in the store buffer", "stores", 1 },
+				   { "store-buffer-forwards", "Loads satisfied from the store buffer", "loads", 1 },
+				   { "scoreboard-stalls", "Cycles issue waited on a pending register or the memory system", "cycles", 1 },
+				   { "issue-group-size", "Instructions issued in each cycle that issued any (issue-width > 1)", "instructions", 1 },
+				   { "fu-stalls", "Cycles issue stopped because every unit of the next instruction's class was busy (issue-width > 1)", "cycles", 1 },
+				   { "thread-instructions", "Instructions executed by each hardware thread (hw-threads > 1, sub-ID is the thread)", "instructions", 1 },
+				   { "thread-stall-cycles", "Cycles each hardware thread waited on a pending register, the memory system or a handler (hw-threads > 1, sub-ID is the thread)", "cycles", 1 }
 				   )
 
             SST_ELI_DOCUMENT_PORTS(
@@ -104,17 +145,123 @@ namespace SST {
     		)
 
         private:
+            void gateClock( const SST::Cycle_t currentCycle, const bool onMemory );
+            void ungateClock();
+            void accountGatedCycles( const SST::Cycle_t cycles );
+
+            bool clockThreads( const SST::Cycle_t currentCycle );
+            void switchThread( const uint32_t thread );
+            bool threadsDrained() const;
+            void reportThreads();
+
+            bool canIssue( const JunoCPUInstruction* inst, const JunoDispatchEntry& entry );
+            bool issueGroup( const SST::Cycle_t currentCycle, bool& memoryStall, SST::Cycle_t& wakeCycle );
+            SST::Cycle_t operandsReadyCycle( const JunoCPUInstruction* inst, const JunoDispatchEntry& entry ) const;
+            bool operationsPending() const {
+                return ldStUnit->operationsPending() || (handlerRequests > 0);
+            }
+
+            bool updateSampling( const SST::Cycle_t currentCycle );
+            void flushStatistics();
+            bool handleStatFlush( SST::Cycle_t currentCycle );
+            bool fastForward();
+            void warmLine( const uint64_t addr );
+            void pushShadowState();
+            void closeSampleWindow( const SST::Cycle_t currentCycle );
+            void reportSampling();
+
+            void buildDispatchTable();
+            void executeBlock( const JunoBasicBlock& block );
+            void handleTextStore( const uint64_t addr, const int64_t value );
+            void recordStore( const uint64_t addr, const int64_t value );
+            void setDispatch( const uint8_t opCode, JunoExecuteFunc execFunc, JunoDispatchKind kind,
+                const bool advancePC, const SST::Cycle_t cycles, Statistic<uint64_t>* opStat, const uint32_t operands );
+            void validateInstruction( const uint64_t addr );
+            std::string describeAddress( const uint64_t addr ) const;
+
+            template<void (*ALUOp)( SST::Output&, const JunoCPUInstruction*, JunoRegisterFile* )>
+            static bool dispatchALU( JunoCPU* cpu, const JunoCPUInstruction* inst );
+            template<void (*MemOp)( SST::Output&, const JunoCPUInstruction*, JunoRegisterFile*, JunoLoadStoreUnit* )>
+            static bool dispatchMem( JunoCPU* cpu, const JunoCPUInstruction* inst );
+            template<void (*JumpOp)( SST::Output&, const JunoCPUInstruction*, JunoRegisterFile*, uint64_t* )>
+            static bool dispatchJump( JunoCPU* cpu, const JunoCPUInstruction* inst );
+            static bool dispatchStore( JunoCPU* cpu, const JunoCPUInstruction* inst );
+            static bool dispatchVectorStore( JunoCPU* cpu, const JunoCPUInstruction* inst );
+            static bool dispatchNoop( JunoCPU* cpu, const JunoCPUInstruction* inst );
+            static bool dispatchHalt( JunoCPU* cpu, const JunoCPUInstruction* inst );
+            static bool dispatchCustom( JunoCPU* cpu, const JunoCPUInstruction* inst );
+            static bool dispatchUnknown( JunoCPU* cpu, const JunoCPUInstruction* inst );
+
             JunoProgramReader* progReader;
+            uint64_t initChunkSize;
             JunoRegisterFile* regFile;
             JunoInstructionMgr* instMgr;
+            JunoBasicBlockCache* blockCache;
             JunoLoadStoreUnit* ldStUnit;
+            JunoStoreBuffer* storeBuffer;
 	    int handlerCount;
+	    // Handlers waiting on an external response, issue stalls until zero
+	    int handlersWaiting;
+	    // Handler requests still outstanding, their registers are pending
+	    uint32_t handlerRequests;
             uint64_t pc;
 
             SimpleMem* mem;
 
+            SST::TimeConverter* cpuClockTC;
+            SST::Clock::Handler<JunoCPU>* cpuClockHandler;
+            SST::Link* wakeLink;
+            bool clockGated;
+            bool gatedOnMemory;
+            SST::Cycle_t gatedCycle;
+            // Gated cycles already counted by a statistics flush
+            SST::Cycle_t gatedAccounted;
+
+            // Hot path counts, pushed into the statistics by flushStatistics
+            JunoCPUCounters counters;
+
+            // Sampled simulation, shadowMem is only created when enabled
+            JunoShadowMemory* shadowMem;
+            bool samplingEnabled;
+            bool fastForwarding;
+            uint64_t ffInstLeft;
+            uint64_t sampleLength;
+            uint64_t sampleInterval;
+            uint64_t windowInsts;
+            SST::Cycle_t windowStartCycle;
+            uint64_t ffInstTotal;
+            uint64_t detailedInstTotal;
+            std::vector<double> windowCPI;
+            uint64_t ffLineBytes;
+            // Ring of lines fast-forwarded loads touched, ffLastLine drops
+            // repeats of the same line
+            std::vector<uint64_t> ffWarmLines;
+            size_t ffWarmNext;
+            size_t ffWarmUsed;
+            uint64_t ffLastLine;
+            // Requests sent by pushShadowState which have not been answered
+            std::unordered_set<SimpleMem::Request::id_t> ffBulkRequests;
+            std::vector<JunoShadowRun> ffDirtyRuns;
+            std::vector<uint64_t> ffScratchLines;
+            bool ffPushed;
+
             SST::Cycle_t instCyclesLeft;
 
+            // Multi-issue model, used when issueWidth > 1 in place of
+            // instCyclesLeft. Results are written at issue, readers wait
+            // until the producer's latency has passed.
+            uint32_t issueWidth;
+            std::vector<SST::Cycle_t> regReadyCycle;
+            JunoUnitPool unitPools[JUNO_UNIT_COUNT];
+
+            // Hardware threads, pc, regFile and ldStUnit above belong to
+            // activeThread. A single thread keeps the original issue path.
+            std::vector<JunoHardwareThread> threads;
+            uint32_t activeThread;
+            uint32_t lastIssuedThread;
+            uint32_t liveThreads;
+            JunoFetchPolicy fetchPolicy;
+
             SST::Cycle_t addCycles;
             SST::Cycle_t subCycles;
             SST::Cycle_t divCycles;
@@ -141,8 +288,16 @@ namespace SST {
 	    Statistic<uint64_t>* statXorIns;
 	    Statistic<uint64_t>* statModIns;
 	    Statistic<uint64_t>* statNotIns;
+	    Statistic<uint64_t>* statFFInstructions;
+	    Statistic<uint64_t>* statLoadMLP;
+	    Statistic<uint64_t>* statScoreboardStalls;
+	    Statistic<uint64_t>* statIssueGroupSize;
+	    Statistic<uint64_t>* statFUStalls;
 
 	    std::vector<JunoCustomInstructionHandler*> customHandlers;
+
+	    // Indexed by op-code, built once the handlers and cycle counts are known
+	    JunoDispatchEntry dispatchTable[256];
         };
 
     }
@@ -0,0 +1,63 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_CPU_COUNTERS
+#define _H_SST_JUNO_CPU_COUNTERS
+
+#include <cinttypes>
+#include <cstring>
+
+#include "junoissue.h"
+
+namespace SST {
+    namespace Juno {
+
+        // Plain counters updated on the hot paths of the CPU, they are
+        // pushed into the SST statistics by JunoCPU::flushStatistics
+        class JunoCPUCounters {
+
+        public:
+            JunoCPUCounters() {
+                clear();
+            }
+
+            void clear() {
+                cycles           = 0;
+                instructions     = 0;
+                ffInstructions   = 0;
+                scoreboardStalls = 0;
+                fuStalls         = 0;
+                memset( (void*) opCounts, 0, sizeof(opCounts) );
+                memset( (void*) issueGroups, 0, sizeof(issueGroups) );
+            }
+
+            uint64_t cycles;
+            uint64_t instructions;
+            uint64_t ffInstructions;
+            uint64_t scoreboardStalls;
+            uint64_t fuStalls;
+            // Issued instructions by op-code
+            uint64_t opCounts[256];
+            // Cycles by the number of instructions issued in them
+            uint64_t issueGroups[JUNO_MAX_ISSUE_WIDTH + 1];
+
+        };
+
+    }
+}
+
+#endif
@@ -24,54 +24,61 @@
 namespace SST {
     namespace Juno {
         
+        // Instructions are decoded once when the program is loaded, every field
+        // is extracted from the 32-bit encoding up front so that the execute
+        // paths only read plain bytes. Kept to 8 bytes so a decoded program is
+        // a dense, cache friendly array.
         class JunoCPUInstruction {
             
         public:
-            JunoCPUInstruction( const int32_t opCode ) : op(opCode) {}
+            JunoCPUInstruction() :
+                op(JUNO_NOOP), readReg1(0), readReg2(0), writeReg(0),
+                jumpOffset(0), absAddr(0) {}
+            
+            JunoCPUInstruction( const int32_t opCode ) {
+                const uint32_t code = static_cast<uint32_t>( opCode );
+                
+                op         = static_cast<uint8_t>( code & 0xFF );
+                readReg1   = static_cast<uint8_t>( (code >> 8) & 0xFF );
+                readReg2   = static_cast<uint8_t>( (code >> 16) & 0xFF );
+                writeReg   = static_cast<uint8_t>( (code >> 24) & 0xFF );
+                jumpOffset = static_cast<int16_t>( (code >> 16) & 0xFFFF );
+                absAddr    = static_cast<uint16_t>( (code >> 8) & 0xFFFF );
+            }
             
             ~JunoCPUInstruction() {}
             
             uint8_t getInstCode() const {
-                return op & 0xFF;
+                return op;
             }
             
             uint8_t getReadReg1() const {
-                int32_t tmp = op & 0xFF00;
-                tmp >>= 8;
-                
-                return static_cast<uint8_t>( tmp & 0xFF );
+                return readReg1;
             }
             
             uint8_t getReadReg2() const {
-                int32_t tmp = op & 0xFF0000;
-                tmp >>= 16;
-                
-                return static_cast<uint8_t>( tmp & 0xFF );
+                return readReg2;
             }
             
             int16_t get16bJumpOffset() const {
-                int32_t tmp = op & 0xFFFF0000;
-                tmp >>= 16;
-                
-                return static_cast<int16_t>( tmp & 0xFFFF );
+                return jumpOffset;
             }
             
             uint16_t get16bAbsAddr() const {
-                int32_t tmp = op & 0x00FFFF00;
-                tmp >>= 8;
-                
-                return static_cast<uint16_t>( tmp & 0xFFFF );
+                return absAddr;
             }
             
             uint8_t getWriteReg() const {
-                int32_t tmp = op & 0xFF000000;
-                tmp >>= 24;
-                
-                return static_cast<uint8_t>( tmp & 0xFF );
+                return writeReg;
             }
             
         protected:
-            int32_t op;
+            uint8_t  op;
+            uint8_t  readReg1;
+            uint8_t  readReg2;
+            uint8_t  writeReg;
+            int16_t  jumpOffset;
+            uint16_t absAddr;
             
         };
         
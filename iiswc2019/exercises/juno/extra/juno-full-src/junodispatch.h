@@ -0,0 +1,105 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_DISPATCH
+#define _H_SST_JUNO_DISPATCH
+
+#include <cinttypes>
+
+#include "junocpuinst.h"
+#include "custominst/junocustinst.h"
+
+// Build with -DJUNO_COMPUTED_GOTO to thread the dispatch in JunoCPU::clockTick
+// through a label table, this needs the GCC/Clang labels-as-values extension
+#if defined(JUNO_COMPUTED_GOTO) && !defined(__GNUC__)
+#undef JUNO_COMPUTED_GOTO
+#endif
+
+namespace SST {
+    namespace Juno {
+
+        class JunoCPU;
+
+        // Every opcode maps to exactly one kind, the kind selects the
+        // label used when dispatching with computed goto
+        enum JunoDispatchKind {
+            JUNO_DISPATCH_UNKNOWN = 0,
+            JUNO_DISPATCH_NOOP,
+            JUNO_DISPATCH_HALT,
+            JUNO_DISPATCH_LOAD,
+            JUNO_DISPATCH_LOAD_ADDR,
+            JUNO_DISPATCH_STORE,
+            JUNO_DISPATCH_VLOAD,
+            JUNO_DISPATCH_VGATHER,
+            JUNO_DISPATCH_VSTORE,
+            JUNO_DISPATCH_ADD,
+            JUNO_DISPATCH_SUB,
+            JUNO_DISPATCH_MUL,
+            JUNO_DISPATCH_DIV,
+            JUNO_DISPATCH_MOD,
+            JUNO_DISPATCH_AND,
+            JUNO_DISPATCH_OR,
+            JUNO_DISPATCH_XOR,
+            JUNO_DISPATCH_NOT,
+            JUNO_DISPATCH_JUMP_ZERO,
+            JUNO_DISPATCH_JUMP_LTZ,
+            JUNO_DISPATCH_JUMP_GTZ,
+            JUNO_DISPATCH_CUSTOM
+        };
+
+        // Vector loads and stores name register groups, their second
+        // register field holds the group size
+        inline bool junoIsVector( const JunoDispatchKind kind ) {
+            return (JUNO_DISPATCH_VLOAD == kind) || (JUNO_DISPATCH_VGATHER == kind) || (JUNO_DISPATCH_VSTORE == kind);
+        }
+
+        // Register fields an op-code uses, checked once at decode
+        enum JunoOperandUsage {
+            JUNO_OPERAND_NONE   = 0,
+            JUNO_OPERAND_READ1  = 0x1,
+            JUNO_OPERAND_READ2  = 0x2,
+            JUNO_OPERAND_WRITE  = 0x4
+        };
+
+        // Returns true if the CPU should stop clocking (HALT)
+        typedef bool (*JunoExecuteFunc)( JunoCPU* cpu, const JunoCPUInstruction* inst );
+
+        class JunoDispatchEntry {
+
+        public:
+            JunoDispatchEntry() :
+                execute(NULL), kind(JUNO_DISPATCH_UNKNOWN), advancePC(false),
+                cycles(0), operands(JUNO_OPERAND_NONE), opStat(NULL), handler(NULL) {}
+
+            JunoExecuteFunc execute;
+            JunoDispatchKind kind;
+            // Fall through to PC+4 after executing, jumps and custom
+            // handlers update the PC themselves
+            bool advancePC;
+            // Cycles the core is occupied after issue
+            SST::Cycle_t cycles;
+            // JunoOperandUsage bits
+            uint32_t operands;
+            Statistic<uint64_t>* opStat;
+            JunoCustomInstructionHandler* handler;
+
+        };
+
+    }
+}
+
+#endif
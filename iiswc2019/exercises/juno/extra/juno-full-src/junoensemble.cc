@@ -0,0 +1,736 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+#include <sst/core/sst_config.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "junoensemble.h"
+#include "junoensemblealu.h"
+
+#include "instmgr/junofixedprogmgr.h"
+
+using namespace SST::Juno;
+
+JunoEnsemble::JunoEnsemble( SST::ComponentId_t id, SST::Params& params ) :
+SST::Component(id) {
+    const int verbosity = params.find<int>("verbose", 0);
+    output.init("JunoEnsemble[" + getName() + ":@p:@t]: ", verbosity, 0, SST::Output::STDOUT);
+
+    contextCount = params.find<uint32_t>("contexts", 4);
+
+    if( 0 == contextCount ) {
+        output.fatal(CALL_INFO, -1, "Error: an ensemble needs at least one context\n");
+    }
+
+    output.verbose(CALL_INFO, 1, 0, "Creating an ensemble of %" PRIu32 " contexts\n", contextCount);
+
+    std::string memIFace = params.find<std::string>("meminterface", "memHierarchy.memInterface");
+    Params interfaceParams = params.find_prefix_params("meminterface.");
+    const std::string portMode = params.find<std::string>("mem-ports", "shared");
+
+    if( "shared" != portMode && "private" != portMode ) {
+        output.fatal(CALL_INFO, -1, "Error: unknown mem-ports mode: %s, expected shared or private\n", portMode.c_str());
+    }
+
+    const uint32_t portCount = ("shared" == portMode) ? 1 : contextCount;
+
+    // Request IDs are unique across interfaces so one handler serves every
+    // port, the request table records which context a response belongs to
+    for( uint32_t i = 0; i < portCount; ++i ) {
+        const std::string portName = ("shared" == portMode) ? "cache_link" : ("cache_link_" + std::to_string(i));
+
+        output.verbose(CALL_INFO, 1, 0, "Loading memory interface: %s for %s ...\n", memIFace.c_str(), portName.c_str());
+        SimpleMem* port = dynamic_cast<SimpleMem*>( loadSubComponent(memIFace, this, interfaceParams) );
+
+        if( NULL == port ) {
+            output.fatal(CALL_INFO, -1, "Error: unable to load %s memory interface.\n", memIFace.c_str());
+        }
+
+        if( ! port->initialize(portName, new SimpleMem::Handler<JunoEnsemble>(this, &JunoEnsemble::handleEvent) ) ) {
+            output.fatal(CALL_INFO, -1, "Port %s was not initialized successfully\n", portName.c_str());
+        }
+
+        memPorts.push_back( port );
+    }
+
+    std::string clock = params.find<std::string>("clock", "1GHz");
+    clockHandler = new SST::Clock::Handler<JunoEnsemble>(this, &JunoEnsemble::clockTick);
+    clockTC = registerClock(clock, clockHandler);
+
+    wakeLink = configureSelfLink("clock-wake", clockTC,
+        new Event::Handler<JunoEnsemble>(this, &JunoEnsemble::handleWake));
+    clockGated  = false;
+    gatedCycle  = 0;
+    gatedStalls = 0;
+
+    registerAsPrimaryComponent();
+    primaryComponentDoNotEndSim();
+
+    std::string progFile = params.find<std::string>("program", "");
+
+    if( "" == progFile ) {
+        output.fatal(CALL_INFO, -1, "Error: program file was not specified, nothing to run!\n");
+    }
+
+    output.verbose(CALL_INFO, 1, 0, "Opening program %s ...\n", progFile.c_str());
+    FILE* progFileHandle = fopen(progFile.c_str(), "r");
+
+    if( NULL == progFileHandle ) {
+        output.fatal(CALL_INFO, -1, "Error: unable to open program: %s\n", progFile.c_str());
+    }
+
+    progReader = new JunoProgramReader( progFileHandle, &output );
+    fclose(progFileHandle);
+
+    initChunkSize = params.find<uint64_t>("init-chunk-size", 65536);
+
+    if( 0 == initChunkSize ) {
+        output.fatal(CALL_INFO, -1, "Error: init-chunk-size must be at least 1 byte\n");
+    }
+
+    // One decoded copy of the text serves every context, self modifying
+    // code is refused (see sendStore)
+    instMgr = new JunoFixedPrgInstMgr( progReader->getTextBuffer(), progReader->getDataLength(), progReader->getInstLength() );
+
+    const int maxReg = params.find<int>("registers", "8");
+    output.verbose(CALL_INFO, 1, 0, "Creating %d 64-bit integer registers per context...\n", maxReg);
+    regFile = new JunoEnsembleRegisterFile( &output, maxReg, contextCount, progReader->getDataLength() +
+        progReader->getInstLength() + progReader->getPadding() );
+
+    maxAddr         = params.find<uint64_t>("max-address", std::numeric_limits<uint64_t>::max());
+    contextStride   = params.find<uint64_t>("context-stride", 0);
+    vectorThreshold = std::max( params.find<uint32_t>("vector-threshold", 4), static_cast<uint32_t>(1) );
+
+    if( contextStride > 0 && contextStride < (progReader->getDataLength() + progReader->getInstLength() + progReader->getPadding()) ) {
+        output.fatal(CALL_INFO, -1, "Error: context-stride (%" PRIu64 ") is smaller than the program image\n", contextStride);
+    }
+
+    pcs.assign( contextCount, progReader->getDataLength() );
+    cyclesLeft.assign( contextCount, 0 );
+    halted.assign( contextCount, 0 );
+    requestsInFlight.assign( contextCount, 0 );
+    stalled.assign( contextCount, 0 );
+    haltedCount = 0;
+
+    readyList.reserve( contextCount );
+    readyGroup.reserve( contextCount );
+    groupedList.resize( contextCount );
+    groupList.reserve( contextCount );
+    groupPCs.reserve( contextCount );
+    groupStarts.reserve( contextCount + 1 );
+
+    uint32_t pcSlotBits = 1;
+
+    while( (static_cast<uint64_t>(1) << pcSlotBits) < 2 * static_cast<uint64_t>(contextCount) ) {
+        pcSlotBits++;
+    }
+
+    pcSlotPC.assign( static_cast<size_t>(1) << pcSlotBits, 0 );
+    pcSlotGroup.assign( pcSlotPC.size(), 0 );
+    pcSlotTag.assign( pcSlotPC.size(), 0 );
+    pcSlotShift = 64 - pcSlotBits;
+    groupEpoch  = 0;
+    lockstepWidths.assign( contextCount + 1, 0 );
+    active.assign( (contextCount + 7) & ~static_cast<uint32_t>(7), 0 );
+
+    const int contextIDReg = params.find<int>("context-id-register", 0);
+
+    if( 0 != contextIDReg ) {
+        if( contextIDReg < 2 || contextIDReg >= maxReg ) {
+            output.fatal(CALL_INFO, -1, "Error: context-id-register (%d) must be a writable register from 2 to %d\n",
+                contextIDReg, maxReg - 1);
+        }
+
+        for( uint32_t ctx = 0; ctx < contextCount; ++ctx ) {
+            regFile->writeReg( ctx, static_cast<uint8_t>(contextIDReg), static_cast<int64_t>(ctx) );
+        }
+    }
+
+    addCycles = params.find<SST::Cycle_t>("cycles-add", 1);
+    subCycles = params.find<SST::Cycle_t>("cycles-sub", 1);
+    mulCycles = params.find<SST::Cycle_t>("cycles-mul", 1);
+    divCycles = params.find<SST::Cycle_t>("cycles-div", 1);
+    modCycles = params.find<SST::Cycle_t>("cycles-mod", 1);
+    andCycles = params.find<SST::Cycle_t>("cycles-and", 1);
+    xorCycles = params.find<SST::Cycle_t>("cycles-xor", 1);
+    orCycles  = params.find<SST::Cycle_t>("cycles-or", 1);
+    notCycles = params.find<SST::Cycle_t>("cycles-not", 1);
+
+    statCycles           = registerStatistic<uint64_t>( "cycles" );
+    statInstructions     = registerStatistic<uint64_t>( "instructions" );
+    statMemReads         = registerStatistic<uint64_t>( "mem-reads" );
+    statMemWrites        = registerStatistic<uint64_t>( "mem-writes" );
+    statScoreboardStalls = registerStatistic<uint64_t>( "scoreboard-stalls" );
+    statLockstepWidth    = registerStatistic<uint64_t>( "lockstep-width" );
+
+    buildDispatchTable();
+
+    for( uint64_t textAddr = progReader->getDataLength();
+        textAddr + 4 <= progReader->getDataLength() + progReader->getInstLength(); textAddr += 4 ) {
+        validateInstruction( textAddr );
+    }
+
+    output.verbose(CALL_INFO, 1, 0, "Initialization done.\n");
+}
+
+JunoEnsemble::~JunoEnsemble() {
+    for( size_t i = 0; i < memPorts.size(); ++i ) {
+        delete memPorts[i];
+    }
+
+    delete regFile;
+    delete instMgr;
+    delete progReader;
+}
+
+void JunoEnsemble::setDispatch( const uint8_t opCode, JunoDispatchKind kind, const bool advancePC,
+    const SST::Cycle_t cycles, Statistic<uint64_t>* opStat, const uint32_t operands ) {
+
+    JunoDispatchEntry& entry = dispatchTable[opCode];
+
+    entry.execute   = NULL;
+    entry.kind      = kind;
+    entry.advancePC = advancePC;
+    entry.cycles    = cycles;
+    entry.operands  = operands;
+    entry.opStat    = opStat;
+    entry.handler   = NULL;
+}
+
+// Same op-codes and timing as JunoCPU, the ensemble has no custom
+// instruction handlers so those op-codes stay unknown
+void JunoEnsemble::buildDispatchTable() {
+    const uint32_t aluOperands = JUNO_OPERAND_READ1 | JUNO_OPERAND_READ2 | JUNO_OPERAND_WRITE;
+
+    for( int i = 0; i < 256; ++i ) {
+        setDispatch( static_cast<uint8_t>(i), JUNO_DISPATCH_UNKNOWN, false, 0, NULL, JUNO_OPERAND_NONE );
+    }
+
+    setDispatch( JUNO_NOOP,      JUNO_DISPATCH_NOOP,      true,  1, NULL, JUNO_OPERAND_NONE );
+    setDispatch( JUNO_HALT,      JUNO_DISPATCH_HALT,      false, 0, NULL, JUNO_OPERAND_NONE );
+    setDispatch( JUNO_LOAD,      JUNO_DISPATCH_LOAD,      true,  0, statMemReads,  JUNO_OPERAND_READ1 | JUNO_OPERAND_WRITE );
+    setDispatch( JUNO_LOAD_ADDR, JUNO_DISPATCH_LOAD_ADDR, true,  0, statMemReads,  JUNO_OPERAND_WRITE );
+    setDispatch( JUNO_STORE,     JUNO_DISPATCH_STORE,     true,  0, statMemWrites, JUNO_OPERAND_READ1 | JUNO_OPERAND_READ2 );
+
+    setDispatch( JUNO_ADD, JUNO_DISPATCH_ADD, true, addCycles, registerStatistic<uint64_t>( "add-ins-count" ), aluOperands );
+    setDispatch( JUNO_SUB, JUNO_DISPATCH_SUB, true, subCycles, registerStatistic<uint64_t>( "sub-ins-count" ), aluOperands );
+    setDispatch( JUNO_MUL, JUNO_DISPATCH_MUL, true, mulCycles, registerStatistic<uint64_t>( "mul-ins-count" ), aluOperands );
+    setDispatch( JUNO_DIV, JUNO_DISPATCH_DIV, true, divCycles, registerStatistic<uint64_t>( "div-ins-count" ), aluOperands );
+    setDispatch( JUNO_MOD, JUNO_DISPATCH_MOD, true, modCycles, registerStatistic<uint64_t>( "mod-ins-count" ), aluOperands );
+    setDispatch( JUNO_AND, JUNO_DISPATCH_AND, true, andCycles, registerStatistic<uint64_t>( "and-ins-count" ), aluOperands );
+    setDispatch( JUNO_OR,  JUNO_DISPATCH_OR,  true, orCycles,  registerStatistic<uint64_t>( "or-ins-count" ),  aluOperands );
+    setDispatch( JUNO_XOR, JUNO_DISPATCH_XOR, true, xorCycles, registerStatistic<uint64_t>( "xor-ins-count" ), aluOperands );
+    setDispatch( JUNO_NOT, JUNO_DISPATCH_NOT, true, notCycles, registerStatistic<uint64_t>( "not-ins-count" ),
+        JUNO_OPERAND_READ1 | JUNO_OPERAND_WRITE );
+
+    setDispatch( JUNO_PCR_JUMP_ZERO, JUNO_DISPATCH_JUMP_ZERO, false, 0, NULL, JUNO_OPERAND_READ1 );
+    setDispatch( JUNO_PCR_JUMP_LTZ,  JUNO_DISPATCH_JUMP_LTZ,  false, 0, NULL, JUNO_OPERAND_READ1 );
+    setDispatch( JUNO_PCR_JUMP_GTZ,  JUNO_DISPATCH_JUMP_GTZ,  false, 0, NULL, JUNO_OPERAND_READ1 );
+}
+
+void JunoEnsemble::validateInstruction( const uint64_t addr ) {
+    const JunoCPUInstruction& inst = instMgr->getInstruction( addr );
+    const JunoDispatchEntry& entry = dispatchTable[ inst.getInstCode() ];
+
+    const uint8_t fields[3] = { inst.getReadReg1(), inst.getReadReg2(), inst.getWriteReg() };
+    const uint32_t usage[3] = { JUNO_OPERAND_READ1, JUNO_OPERAND_READ2, JUNO_OPERAND_WRITE };
+
+    for( int i = 0; i < 3; ++i ) {
+        if( 0 != (entry.operands & usage[i]) && ! regFile->isValidRegister( fields[i] ) ) {
+            output.fatal(CALL_INFO, -1, "Instruction at %" PRIu64 " accessed register %" PRIu8 ", but max is: %d.\n",
+                addr, fields[i], regFile->getRegisterCount());
+        }
+    }
+
+    if( 0 != (entry.operands & JUNO_OPERAND_WRITE) && inst.getWriteReg() <= 1 ) {
+        output.fatal(CALL_INFO, -1, "Instruction at %" PRIu64 " attempts write to register %" PRIu8 " but r0 and r1 are hardware reserved.\n",
+            addr, inst.getWriteReg());
+    }
+}
+
+void JunoEnsemble::init( unsigned int phase ) {
+    for( size_t i = 0; i < memPorts.size(); ++i ) {
+        memPorts[i]->init( phase );
+    }
+
+    if( 0 != phase ) {
+        return;
+    }
+
+    // Every private port gets the image, a shared port gets one copy per
+    // context address space
+    const uint32_t copies = (1 == memPorts.size() && 0 == contextStride) ? 1 : contextCount;
+
+    output.verbose(CALL_INFO, 1, 0, "Sending %" PRIu32 " copies of the program image to memory...\n", copies);
+
+    // Only the initialized extents are sent, memory starts zeroed
+    for( uint32_t ctx = 0; ctx < copies; ++ctx ) {
+        const uint64_t ctxBase = static_cast<uint64_t>(ctx) * contextStride;
+
+        for( size_t i = 0; i < progReader->getExtentCount(); ++i ) {
+            const JunoProgramExtent& extent = progReader->getExtent( i );
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>( extent.bytes );
+
+            for( uint64_t offset = 0; offset < extent.length; offset += initChunkSize ) {
+                const uint64_t chunkLen = std::min( initChunkSize, extent.length - offset );
+
+                SimpleMem::Request* writeExe = new SimpleMem::Request(SimpleMem::Request::Write,
+                    ctxBase + extent.addr + offset, chunkLen);
+                writeExe->data.assign( bytes + offset, bytes + offset + chunkLen );
+
+                portFor( ctx )->sendInitData( writeExe );
+            }
+        }
+    }
+}
+
+void JunoEnsemble::setup() {
+}
+
+void JunoEnsemble::finish() {
+    flushStatistics();
+}
+
+void JunoEnsemble::flushStatistics() {
+    statCycles->addDataNTimes( counters.cycles, 1 );
+    statInstructions->addDataNTimes( counters.instructions, 1 );
+    statScoreboardStalls->addDataNTimes( counters.scoreboardStalls, 1 );
+
+    for( int op = 0; op < 256; ++op ) {
+        if( counters.opCounts[op] > 0 && NULL != dispatchTable[op].opStat ) {
+            dispatchTable[op].opStat->addDataNTimes( counters.opCounts[op], 1 );
+        }
+    }
+
+    for( size_t width = 1; width < lockstepWidths.size(); ++width ) {
+        if( lockstepWidths[width] > 0 ) {
+            statLockstepWidth->addDataNTimes( lockstepWidths[width], static_cast<uint64_t>( width ) );
+            lockstepWidths[width] = 0;
+        }
+    }
+
+    counters.clear();
+}
+
+void JunoEnsemble::checkAddress( const uint32_t ctx, const uint64_t addr ) {
+    if( addr >= maxAddr ) {
+        output.fatal(CALL_INFO, -1, "Context %" PRIu32 " requested address: %" PRIu64 " but maximum address is: %" PRIu64 "\n",
+            ctx, addr, maxAddr);
+    }
+}
+
+void JunoEnsemble::sendLoad( const uint32_t ctx, const uint64_t addr, const uint8_t reg ) {
+    JUNO_VERBOSE(output, 16, "Context %" PRIu32 " load from address: %" PRIu64 " into register: %" PRIu8 "\n",
+        ctx, addr, reg);
+
+    checkAddress( ctx, addr );
+
+    SimpleMem::Request* req = new SimpleMem::Request(SimpleMem::Request::Read,
+        addr + (static_cast<uint64_t>(ctx) * contextStride), 8);
+
+    requests[ req->id ] = JunoEnsembleRequest( ctx, reg, true );
+    regFile->setPending( ctx, reg );
+    requestsInFlight[ctx]++;
+
+    portFor( ctx )->sendRequest( req );
+}
+
+void JunoEnsemble::sendStore( const uint32_t ctx, const uint64_t addr, const uint8_t reg ) {
+    JUNO_VERBOSE(output, 16, "Context %" PRIu32 " store from register %" PRIu8 " to address: %" PRIu64 "\n",
+        ctx, reg, addr);
+
+    checkAddress( ctx, addr );
+
+    if( addr < (progReader->getDataLength() + progReader->getInstLength()) &&
+        (addr + 8) > progReader->getDataLength() ) {
+        output.fatal(CALL_INFO, -1, "Error: context %" PRIu32 " stores to the program text at %" PRIu64 ", contexts share one decoded program so this is not supported\n",
+            ctx, addr);
+    }
+
+    const int64_t regValue = regFile->readReg( ctx, reg );
+
+    SimpleMem::Request* req = new SimpleMem::Request(SimpleMem::Request::Write,
+        addr + (static_cast<uint64_t>(ctx) * contextStride), 8);
+
+    std::vector<uint8_t> payload( sizeof(regValue) );
+    memcpy( (void*) &payload[0], (void*) &regValue, sizeof(regValue) );
+    req->setPayload( payload );
+
+    requests[ req->id ] = JunoEnsembleRequest( ctx, reg, false );
+    requestsInFlight[ctx]++;
+
+    portFor( ctx )->sendRequest( req );
+}
+
+void JunoEnsemble::handleEvent( SimpleMem::Request* ev ) {
+    auto reqItr = requests.find( ev->id );
+
+    if( reqItr == requests.end() ) {
+        output.fatal(CALL_INFO, -1, "Error: response from memory could not be found.\n");
+    }
+
+    const JunoEnsembleRequest& req = reqItr->second;
+
+    if( req.isLoad ) {
+        int64_t newValue = 0;
+        memcpy( (void*) &newValue, &ev->data[0], sizeof(newValue) );
+
+        JUNO_VERBOSE(output, 8, "Context %" PRIu32 " read response, payload=%" PRId64 ", for reg: %" PRIu8 "\n",
+            req.context, newValue, req.regTarget);
+
+        regFile->writeReg( req.context, req.regTarget, newValue );
+        regFile->clearPending( req.context, req.regTarget );
+    }
+
+    requestsInFlight[ req.context ]--;
+    requests.erase( reqItr );
+
+    delete ev;
+
+    if( clockGated ) {
+        ungateClock();
+    }
+}
+
+void JunoEnsemble::handleWake( SST::Event* ev ) {
+    delete ev;
+
+    if( clockGated ) {
+        ungateClock();
+    }
+}
+
+void JunoEnsemble::gateClock( const SST::Cycle_t currentCycle, const uint32_t memoryStalls ) {
+    JUNO_VERBOSE(output, 16, "No context can issue, gating clock at cycle %" PRIu64 "\n",
+        static_cast<uint64_t>(currentCycle));
+
+    clockGated  = true;
+    gatedCycle  = currentCycle;
+    gatedStalls = memoryStalls;
+}
+
+void JunoEnsemble::ungateClock() {
+    const SST::Cycle_t nextCycle = reregisterClock( clockTC, clockHandler );
+    const SST::Cycle_t skipped   = nextCycle - gatedCycle - 1;
+
+    JUNO_VERBOSE(output, 16, "Clock restarts at cycle %" PRIu64 " (%" PRIu64 " cycles gated)\n",
+        static_cast<uint64_t>(nextCycle), static_cast<uint64_t>(skipped));
+
+    counters.cycles += skipped;
+    counters.scoreboardStalls += skipped * gatedStalls;
+
+    for( uint32_t ctx = 0; ctx < contextCount; ++ctx ) {
+        cyclesLeft[ctx] -= std::min( cyclesLeft[ctx], skipped );
+    }
+
+    clockGated = false;
+}
+
+bool JunoEnsemble::canIssue( const uint32_t ctx, const JunoCPUInstruction* inst, const JunoDispatchEntry& entry ) {
+    if( 0 == requestsInFlight[ctx] ) {
+        return true;
+    }
+
+    switch( entry.kind ) {
+    case JUNO_DISPATCH_NOOP:
+        return true;
+    case JUNO_DISPATCH_LOAD:
+    case JUNO_DISPATCH_LOAD_ADDR:
+    case JUNO_DISPATCH_STORE:
+    case JUNO_DISPATCH_HALT:
+    case JUNO_DISPATCH_UNKNOWN:
+        // Memory operations of one context are kept in order
+        return false;
+    case JUNO_DISPATCH_JUMP_ZERO:
+    case JUNO_DISPATCH_JUMP_LTZ:
+    case JUNO_DISPATCH_JUMP_GTZ:
+        return ! regFile->isPending( ctx, inst->getReadReg1() );
+    default:
+        return ! regFile->isPending( ctx, inst->getReadReg1() ) &&
+            ! regFile->isPending( ctx, inst->getReadReg2() ) &&
+            ! regFile->isPending( ctx, inst->getWriteReg() );
+    }
+}
+
+void JunoEnsemble::executeALU( const JunoCPUInstruction* inst, const JunoDispatchEntry& entry ) {
+    // Wide groups take one pass over the rows under the active mask, a few
+    // stragglers are cheaper to visit one by one
+    const bool wide = (static_cast<uint64_t>( groupList.size() ) * vectorThreshold) >= contextCount;
+    const uint32_t groupSize = static_cast<uint32_t>( groupList.size() );
+
+#define JUNO_ENSEMBLE_ALU(OpClass) \
+    if( wide ) { \
+        executeEnsembleALU<OpClass>( output, inst, regFile, &active[0] ); \
+    } else { \
+        executeEnsembleALU<OpClass>( output, inst, regFile, &groupList[0], groupSize ); \
+    }
+
+    switch( entry.kind ) {
+    case JUNO_DISPATCH_ADD: JUNO_ENSEMBLE_ALU(JunoAddOp); break;
+    case JUNO_DISPATCH_SUB: JUNO_ENSEMBLE_ALU(JunoSubOp); break;
+    case JUNO_DISPATCH_MUL: JUNO_ENSEMBLE_ALU(JunoMulOp); break;
+    case JUNO_DISPATCH_DIV: JUNO_ENSEMBLE_ALU(JunoDivOp); break;
+    case JUNO_DISPATCH_MOD: JUNO_ENSEMBLE_ALU(JunoModOp); break;
+    case JUNO_DISPATCH_AND: JUNO_ENSEMBLE_ALU(JunoAndOp); break;
+    case JUNO_DISPATCH_OR:  JUNO_ENSEMBLE_ALU(JunoOrOp);  break;
+    case JUNO_DISPATCH_XOR: JUNO_ENSEMBLE_ALU(JunoXorOp); break;
+    case JUNO_DISPATCH_NOT: JUNO_ENSEMBLE_ALU(JunoNotOp); break;
+    default:
+        break;
+    }
+
+#undef JUNO_ENSEMBLE_ALU
+}
+
+void JunoEnsemble::executeJump( const uint32_t ctx, const JunoCPUInstruction* inst, const JunoDispatchEntry& entry ) {
+    const int64_t regVal = regFile->readReg( ctx, inst->getReadReg1() );
+    bool taken = false;
+
+    switch( entry.kind ) {
+    case JUNO_DISPATCH_JUMP_ZERO: taken = (0 == regVal); break;
+    case JUNO_DISPATCH_JUMP_LTZ:  taken = (regVal < 0);  break;
+    default:                      taken = (regVal > 0);  break;
+    }
+
+    const int64_t pcDiff = static_cast<int64_t>( inst->get16bJumpOffset() ) * 4;
+
+    JUNO_VERBOSE(output, 4, "Context %" PRIu32 " jump on r%" PRIu8 " (%" PRId64 "), offset=%" PRId64 ", taken=%d\n",
+        ctx, inst->getReadReg1(), regVal, pcDiff, taken ? 1 : 0);
+
+    pcs[ctx] = taken ? static_cast<uint64_t>( static_cast<int64_t>( pcs[ctx] ) + pcDiff ) : (pcs[ctx] + 4);
+}
+
+void JunoEnsemble::issueGroup( const JunoCPUInstruction* inst, const JunoDispatchEntry& entry ) {
+    const uint32_t groupSize = static_cast<uint32_t>( groupList.size() );
+
+    switch( entry.kind ) {
+    case JUNO_DISPATCH_NOOP:
+        break;
+    case JUNO_DISPATCH_HALT:
+        for( uint32_t i = 0; i < groupSize; ++i ) {
+            JUNO_VERBOSE(output, 2, "Context %" PRIu32 " halted\n", groupList[i]);
+            halted[ groupList[i] ] = 1;
+        }
+
+        haltedCount += groupSize;
+        break;
+    case JUNO_DISPATCH_LOAD:
+        for( uint32_t i = 0; i < groupSize; ++i ) {
+            const uint32_t ctx = groupList[i];
+            sendLoad( ctx, static_cast<uint64_t>( regFile->readReg( ctx, inst->getReadReg1() ) ), inst->getWriteReg() );
+        }
+        break;
+    case JUNO_DISPATCH_LOAD_ADDR:
+        for( uint32_t i = 0; i < groupSize; ++i ) {
+            sendLoad( groupList[i], static_cast<uint64_t>( inst->get16bAbsAddr() ), inst->getWriteReg() );
+        }
+        break;
+    case JUNO_DISPATCH_STORE:
+        for( uint32_t i = 0; i < groupSize; ++i ) {
+            const uint32_t ctx = groupList[i];
+            sendStore( ctx, static_cast<uint64_t>( regFile->readReg( ctx, inst->getReadReg2() ) ), inst->getReadReg1() );
+        }
+        break;
+    case JUNO_DISPATCH_JUMP_ZERO:
+    case JUNO_DISPATCH_JUMP_LTZ:
+    case JUNO_DISPATCH_JUMP_GTZ:
+        // Contexts may branch different ways and split into new groups
+        for( uint32_t i = 0; i < groupSize; ++i ) {
+            executeJump( groupList[i], inst, entry );
+        }
+        break;
+    case JUNO_DISPATCH_UNKNOWN:
+    case JUNO_DISPATCH_CUSTOM:
+        output.fatal(CALL_INFO, -1, "Error: context %" PRIu32 " reached unknown op-code %" PRIu8 " at %" PRIu64 " (custom instructions are not supported in an ensemble)\n",
+            groupList[0], inst->getInstCode(), pcs[ groupList[0] ]);
+        break;
+    default:
+        executeALU( inst, entry );
+        break;
+    }
+
+    for( uint32_t i = 0; i < groupSize; ++i ) {
+        const uint32_t ctx = groupList[i];
+
+        if( entry.advancePC ) {
+            pcs[ctx] += 4;
+        }
+
+        cyclesLeft[ctx] = entry.cycles;
+    }
+
+    counters.instructions += groupSize;
+    counters.opCounts[ inst->getInstCode() ] += groupSize;
+    lockstepWidths[groupSize]++;
+}
+
+bool JunoEnsemble::clockTick( SST::Cycle_t currentCycle ) {
+    counters.cycles++;
+    JUNO_VERBOSE(output, 8, "Cycle: %" PRIu64 "\n", static_cast<uint64_t>(currentCycle));
+
+    uint32_t memoryStalls = 0;
+    readyList.clear();
+
+    for( uint32_t ctx = 0; ctx < contextCount; ++ctx ) {
+        stalled[ctx] = 0;
+
+        if( 0 != halted[ctx] || cyclesLeft[ctx] > 0 ) {
+            continue;
+        }
+
+        const JunoCPUInstruction* inst = &instMgr->getInstruction( pcs[ctx] );
+
+        if( canIssue( ctx, inst, dispatchTable[ inst->getInstCode() ] ) ) {
+            // r0 mirrors the PC of the instruction about to issue
+            regFile->row(0)[ctx] = static_cast<int64_t>( pcs[ctx] );
+            readyList.push_back( ctx );
+        } else {
+            stalled[ctx] = 1;
+            memoryStalls++;
+        }
+    }
+
+    counters.scoreboardStalls += memoryStalls;
+
+    // Contexts at the same PC issue together. Groups go in the order their
+    // first context is ready, contexts within a group in ascending order.
+    groupPCs.clear();
+    groupStarts.clear();
+    readyGroup.clear();
+
+    if( 0 == ++groupEpoch ) {
+        std::fill( pcSlotTag.begin(), pcSlotTag.end(), 0 );
+        groupEpoch = 1;
+    }
+
+    const size_t pcSlotMask = pcSlotPC.size() - 1;
+
+    uint64_t lastPC = 0;
+    uint32_t lastGroup = 0;
+
+    for( size_t i = 0; i < readyList.size(); ++i ) {
+        const uint64_t ctxPC = pcs[ readyList[i] ];
+
+        // Neighbouring contexts are usually at the same PC, skip the lookup
+        if( groupPCs.empty() || ctxPC != lastPC ) {
+            size_t slot = static_cast<size_t>( (ctxPC * UINT64_C(0x9E3779B97F4A7C15)) >> pcSlotShift );
+
+            while( groupEpoch == pcSlotTag[slot] && ctxPC != pcSlotPC[slot] ) {
+                slot = (slot + 1) & pcSlotMask;
+            }
+
+            if( groupEpoch != pcSlotTag[slot] ) {
+                lastGroup = static_cast<uint32_t>( groupPCs.size() );
+                pcSlotTag[slot]   = groupEpoch;
+                pcSlotPC[slot]    = ctxPC;
+                pcSlotGroup[slot] = lastGroup;
+                groupPCs.push_back( ctxPC );
+                groupStarts.push_back( 0 );
+            } else {
+                lastGroup = pcSlotGroup[slot];
+            }
+
+            lastPC = ctxPC;
+        }
+
+        readyGroup.push_back( lastGroup );
+        groupStarts[lastGroup]++;
+    }
+
+    // Counts to start offsets, then place each context in its bucket
+    uint32_t offset = 0;
+
+    for( size_t g = 0; g < groupStarts.size(); ++g ) {
+        const uint32_t groupSize = groupStarts[g];
+        groupStarts[g] = offset;
+        offset += groupSize;
+    }
+
+    groupStarts.push_back( offset );
+
+    for( size_t i = 0; i < readyList.size(); ++i ) {
+        groupedList[ groupStarts[ readyGroup[i] ]++ ] = readyList[i];
+    }
+
+    // Placing advanced every start to the next group's, shift them back
+    for( size_t g = groupStarts.size() - 1; g > 0; --g ) {
+        groupStarts[g] = groupStarts[g - 1];
+    }
+
+    groupStarts[0] = 0;
+
+    for( size_t g = 0; g < groupPCs.size(); ++g ) {
+        groupList.assign( groupedList.begin() + groupStarts[g], groupedList.begin() + groupStarts[g + 1] );
+
+        for( size_t i = 0; i < groupList.size(); ++i ) {
+            active[ groupList[i] ] = 1;
+        }
+
+        const JunoCPUInstruction* inst = &instMgr->getInstruction( groupPCs[g] );
+
+        JUNO_VERBOSE(output, 2, "Issuing PC=%" PRIu64 " for %" PRIu64 " contexts\n", groupPCs[g],
+            static_cast<uint64_t>( groupList.size() ));
+
+        issueGroup( inst, dispatchTable[ inst->getInstCode() ] );
+
+        // Only this group's bits were set, clear just those
+        for( size_t i = 0; i < groupList.size(); ++i ) {
+            active[ groupList[i] ] = 0;
+        }
+    }
+
+    if( haltedCount == contextCount ) {
+        output.verbose(CALL_INFO, 1, 0, "Every context has halted\n");
+        primaryComponentOKToEndSim();
+        return true;
+    }
+
+    // A context stalled on memory stays stalled until a response arrives,
+    // sleep if every other context is busy for more than the next cycle
+    SST::Cycle_t minBusy = std::numeric_limits<SST::Cycle_t>::max();
+    bool canSleep = true;
+
+    for( uint32_t ctx = 0; ctx < contextCount; ++ctx ) {
+        if( cyclesLeft[ctx] > 0 ) {
+            cyclesLeft[ctx]--;
+        }
+
+        if( 0 != halted[ctx] || 0 != stalled[ctx] ) {
+            continue;
+        }
+
+        if( cyclesLeft[ctx] > 1 ) {
+            minBusy = std::min( minBusy, cyclesLeft[ctx] );
+        } else {
+            canSleep = false;
+        }
+    }
+
+    if( ! canSleep ) {
+        return false;
+    }
+
+    gateClock( currentCycle, memoryStalls );
+
+    if( minBusy != std::numeric_limits<SST::Cycle_t>::max() ) {
+        wakeLink->send( minBusy - 2, new SST::NullEvent() );
+    }
+
+    return true;
+}
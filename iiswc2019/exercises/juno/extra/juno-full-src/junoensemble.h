@@ -0,0 +1,232 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+#ifndef _SST_JUNO_ENSEMBLE_H
+#define _SST_JUNO_ENSEMBLE_H
+
+#include <sst/core/sst_config.h>
+#include <sst/core/component.h>
+#include <sst/core/elementinfo.h>
+
+#include <sst/core/interfaces/simpleMem.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "junoprogreader.h"
+#include "junoensembleregs.h"
+#include "junoinstmgr.h"
+#include "junocpuinst.h"
+#include "junodispatch.h"
+#include "junoverbose.h"
+#include "junocpucounters.h"
+
+using namespace SST::Interfaces;
+using namespace SST::Juno;
+
+namespace SST {
+    namespace Juno {
+
+        // A memory request in flight for one context of the ensemble
+        class JunoEnsembleRequest {
+
+        public:
+            JunoEnsembleRequest() : context(0), regTarget(0), isLoad(false) {}
+            JunoEnsembleRequest( const uint32_t ctx, const uint8_t reg, const bool load ) :
+                context(ctx), regTarget(reg), isLoad(load) {}
+
+            uint32_t context;
+            uint8_t regTarget;
+            bool isLoad;
+
+        };
+
+        // Many independent Juno cores in one component, all running the same
+        // program with their own registers, PC and timing. Contexts at the
+        // same PC issue together and ALU operations are applied to all of them
+        // in one pass over the structure of arrays register file.
+        class JunoEnsemble : public SST::Component {
+
+        public:
+            JunoEnsemble( SST::ComponentId_t id, SST::Params& params );
+            ~JunoEnsemble();
+
+            void setup();
+            void finish();
+
+            void init( unsigned int phase );
+
+            bool clockTick( SST::Cycle_t currentCycle );
+            void handleEvent( SimpleMem::Request* ev );
+            void handleWake( SST::Event* ev );
+
+            SST_ELI_REGISTER_COMPONENT(
+                                       JunoEnsemble,
+                                       "juno",
+                                       "JunoEnsemble",
+                                       SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+                                       "Many independent Juno contexts simulated by one component",
+                                       COMPONENT_CATEGORY_PROCESSOR
+                                       )
+
+            SST_ELI_DOCUMENT_PARAMS(
+                                    { "contexts", "Number of independent hardware contexts to simulate", "4" },
+                                    { "program", "The assembly file every context runs.", "" },
+                                    { "registers", "64-bit integer registers in each context", "8" },
+                                    { "verbose", "Sets the verbosity level of output, per-instruction messages above JUNO_MAX_VERBOSE are compiled out", "0" },
+                                    { "clock", "Clock for every context", "1GHz" },
+                                    { "cycles-add", "Cycles to spend on an ADD operation", "1"},
+                                    { "cycles-sub", "Cycles to spend on an SUB operation", "1"},
+                                    { "cycles-mul", "Cycles to spend on an MUL operation", "1"},
+                                    { "cycles-div", "Cycles to spend on an DIV operation", "1"},
+                                    { "cycles-mod", "Cycles to spend on an MOD operation", "1"},
+                                    { "cycles-and", "Cycles to spend on an AND operation", "1"},
+                                    { "cycles-xor", "Cycles to spend on an XOR operation", "1"},
+                                    { "cycles-or",  "Cycles to spend on an OR operation", "1"},
+                                    { "cycles-not",  "Cycles to spend on an NOT (bit flip) operation", "1"},
+                                    { "max-address", "Set a maximum address that memory addresses are allowed to access (debugging mechanism)", "2147483647" },
+                                    { "init-chunk-size", "Most bytes sent to memory in one initialization request, only initialized extents of the program are sent", "65536" },
+                                    { "mem-ports", "shared: one cache_link carries every context's requests, private: context N uses cache_link_N", "shared" },
+                                    { "context-stride", "Bytes between the address spaces of consecutive contexts, each gets its own copy of the program image when non-zero", "0" },
+                                    { "context-id-register", "Register set to the context number at start so contexts can pick their sweep point, 0 for none", "0" },
+                                    { "vector-threshold", "Issue an ALU op with one pass over all contexts when at least contexts/threshold of them share it, otherwise per context", "4" }
+                                    )
+
+            SST_ELI_DOCUMENT_STATISTICS(
+                                   { "cycles", "Cycles the ensemble was active", "cycles", 1 },
+                                   { "instructions", "Instructions executed by all contexts", "instructions", 1 },
+                                   { "mem-reads", "Memory reads issued by all contexts", "instructions", 1 },
+                                   { "mem-writes", "Memory writes issued by all contexts", "instructions", 1 },
+                                   { "add-ins-count", "ADD instructions issued by all contexts", "instructions", 1 },
+                                   { "sub-ins-count", "SUB instructions issued by all contexts", "instructions", 1 },
+                                   { "mul-ins-count", "MUL instructions issued by all contexts", "instructions", 1 },
+                                   { "div-ins-count", "DIV instructions issued by all contexts", "instructions", 1 },
+                                   { "mod-ins-count", "MOD instructions issued by all contexts", "instructions", 1 },
+                                   { "and-ins-count", "AND instructions issued by all contexts", "instructions", 1 },
+                                   { "or-ins-count", "OR instructions issued by all contexts", "instructions", 1 },
+                                   { "xor-ins-count", "XOR instructions issued by all contexts", "instructions", 1 },
+                                   { "not-ins-count", "NOT instructions issued by all contexts", "instructions", 1 },
+                                   { "scoreboard-stalls", "Context cycles spent waiting on a pending register or the memory system", "cycles", 1 },
+                                   { "lockstep-width", "Contexts issuing together each time a group of contexts at the same PC issues", "contexts", 1 }
+                                   )
+
+            SST_ELI_DOCUMENT_PORTS(
+                                   { "cache_link", "Shared memory port for every context (mem-ports=shared)", {} },
+                                   { "cache_link_%(contexts)d", "Memory port of each context (mem-ports=private)", {} }
+                                   )
+
+        private:
+            void gateClock( const SST::Cycle_t currentCycle, const uint32_t memoryStalls );
+            void ungateClock();
+
+            void buildDispatchTable();
+            void setDispatch( const uint8_t opCode, JunoDispatchKind kind, const bool advancePC,
+                const SST::Cycle_t cycles, Statistic<uint64_t>* opStat, const uint32_t operands );
+            void validateInstruction( const uint64_t addr );
+
+            bool canIssue( const uint32_t ctx, const JunoCPUInstruction* inst, const JunoDispatchEntry& entry );
+            void issueGroup( const JunoCPUInstruction* inst, const JunoDispatchEntry& entry );
+            void executeALU( const JunoCPUInstruction* inst, const JunoDispatchEntry& entry );
+            void executeJump( const uint32_t ctx, const JunoCPUInstruction* inst, const JunoDispatchEntry& entry );
+            void sendLoad( const uint32_t ctx, const uint64_t addr, const uint8_t reg );
+            void sendStore( const uint32_t ctx, const uint64_t addr, const uint8_t reg );
+            void checkAddress( const uint32_t ctx, const uint64_t addr );
+            SimpleMem* portFor( const uint32_t ctx ) {
+                return memPorts[ (1 == memPorts.size()) ? 0 : ctx ];
+            }
+
+            void flushStatistics();
+
+            JunoProgramReader* progReader;
+            uint64_t initChunkSize;
+            JunoInstructionMgr* instMgr;
+            JunoEnsembleRegisterFile* regFile;
+
+            uint32_t contextCount;
+            uint64_t contextStride;
+            uint64_t maxAddr;
+            uint32_t vectorThreshold;
+
+            // Per context state, indexed by context
+            std::vector<uint64_t> pcs;
+            std::vector<SST::Cycle_t> cyclesLeft;
+            std::vector<uint8_t> halted;
+            std::vector<uint32_t> requestsInFlight;
+            // Set for contexts which could not issue this cycle
+            std::vector<uint8_t> stalled;
+            uint32_t haltedCount;
+
+            // Scratch for grouping contexts by PC each cycle, active is
+            // padded like a register row. Ready contexts are bucketed once
+            // into groupedList, group g runs from groupStarts[g] to
+            // groupStarts[g + 1].
+            std::vector<uint32_t> readyList;
+            std::vector<uint32_t> readyGroup;
+            std::vector<uint64_t> groupPCs;
+            std::vector<uint32_t> groupStarts;
+            std::vector<uint32_t> groupedList;
+            std::vector<uint32_t> groupList;
+            std::vector<uint8_t> active;
+
+            // Open-addressed PC to group table, at least twice the context
+            // count so probes stay short. A slot is only live when its tag
+            // matches groupEpoch, which saves clearing it every cycle.
+            std::vector<uint64_t> pcSlotPC;
+            std::vector<uint32_t> pcSlotGroup;
+            std::vector<uint32_t> pcSlotTag;
+            uint32_t groupEpoch;
+            uint32_t pcSlotShift;
+
+            std::vector<SimpleMem*> memPorts;
+            std::unordered_map<SimpleMem::Request::id_t, JunoEnsembleRequest> requests;
+
+            SST::TimeConverter* clockTC;
+            SST::Clock::Handler<JunoEnsemble>* clockHandler;
+            SST::Link* wakeLink;
+            bool clockGated;
+            SST::Cycle_t gatedCycle;
+            // Contexts waiting on memory when the clock was gated
+            uint32_t gatedStalls;
+
+            SST::Cycle_t addCycles;
+            SST::Cycle_t subCycles;
+            SST::Cycle_t divCycles;
+            SST::Cycle_t mulCycles;
+            SST::Cycle_t andCycles;
+            SST::Cycle_t orCycles;
+            SST::Cycle_t xorCycles;
+            SST::Cycle_t modCycles;
+            SST::Cycle_t notCycles;
+
+            SST::Output output;
+
+            Statistic<uint64_t>* statCycles;
+            Statistic<uint64_t>* statInstructions;
+            Statistic<uint64_t>* statMemReads;
+            Statistic<uint64_t>* statMemWrites;
+            Statistic<uint64_t>* statScoreboardStalls;
+            Statistic<uint64_t>* statLockstepWidth;
+            JunoCPUCounters counters;
+            // Groups issued by their width, flushed with the counters
+            std::vector<uint64_t> lockstepWidths;
+
+            JunoDispatchEntry dispatchTable[256];
+        };
+
+    }
+}
+
+#endif
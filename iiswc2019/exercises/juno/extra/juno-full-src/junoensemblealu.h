@@ -0,0 +1,101 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_ENSEMBLE_ALU
+#define _H_SST_JUNO_ENSEMBLE_ALU
+
+#include <cinttypes>
+
+#include "junocpuinst.h"
+#include "junoopcodes.h"
+#include "junoensembleregs.h"
+#include "junoverbose.h"
+
+namespace SST {
+    namespace Juno {
+        
+        // Operations applied across the contexts of a JunoEnsemble. Each
+        // op is a plain function of its operands so the loops below can be
+        // vectorized over a register row. DIV and MOD can trap and are only
+        // evaluated for the contexts which issued them.
+        class JunoAddOp { public: static const bool safe = true;  static int64_t apply( const int64_t l, const int64_t r ) { return l + r; } };
+        class JunoSubOp { public: static const bool safe = true;  static int64_t apply( const int64_t l, const int64_t r ) { return l - r; } };
+        class JunoMulOp { public: static const bool safe = true;  static int64_t apply( const int64_t l, const int64_t r ) {
+            return static_cast<int64_t>( static_cast<uint64_t>(l) * static_cast<uint64_t>(r) ); } };
+        class JunoDivOp { public: static const bool safe = false; static int64_t apply( const int64_t l, const int64_t r ) { return l / r; } };
+        class JunoModOp { public: static const bool safe = false; static int64_t apply( const int64_t l, const int64_t r ) { return l % r; } };
+        class JunoAndOp { public: static const bool safe = true;  static int64_t apply( const int64_t l, const int64_t r ) { return l & r; } };
+        class JunoOrOp  { public: static const bool safe = true;  static int64_t apply( const int64_t l, const int64_t r ) { return l | r; } };
+        class JunoXorOp { public: static const bool safe = true;  static int64_t apply( const int64_t l, const int64_t r ) { return l ^ r; } };
+        class JunoNotOp { public: static const bool safe = true;  static int64_t apply( const int64_t l, const int64_t r ) { return ~l; } };
+        
+        // Every context with active[ctx] set executes inst, the others keep
+        // their result register. NOT reads its single operand as both sides.
+        template<class Op>
+        inline void executeEnsembleALU( SST::Output& output, const JunoCPUInstruction* inst,
+            JunoEnsembleRegisterFile* regFile, const uint8_t* active ) {
+            
+            const int64_t* left  = regFile->row( inst->getReadReg1() );
+            const int64_t* right = regFile->row( (JUNO_NOT == inst->getInstCode()) ? inst->getReadReg1() : inst->getReadReg2() );
+            int64_t* result      = regFile->row( inst->getWriteReg() );
+            const uint32_t contexts = regFile->getContextCount();
+            
+            JUNO_VERBOSE(output, 4, "Ensemble op %" PRIu8 "[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "] across %" PRIu32 " contexts\n",
+                           inst->getInstCode(), inst->getReadReg1(), inst->getReadReg2(), inst->getWriteReg(), contexts);
+            
+            if( Op::safe ) {
+                // Computed for every context and merged under a bit mask,
+                // keeps the loop free of branches and selects
+                for( uint32_t ctx = 0; ctx < contexts; ++ctx ) {
+                    const int64_t value = Op::apply( left[ctx], right[ctx] );
+                    const int64_t mask  = -static_cast<int64_t>( active[ctx] );
+                    result[ctx] = (value & mask) | (result[ctx] & ~mask);
+                }
+            } else {
+                for( uint32_t ctx = 0; ctx < contexts; ++ctx ) {
+                    if( 0 != active[ctx] ) {
+                        result[ctx] = Op::apply( left[ctx], right[ctx] );
+                    }
+                }
+            }
+        };
+        
+        // Same operation for a short list of contexts, used when only a few
+        // contexts share the instruction and a pass over the row would
+        // mostly be wasted
+        template<class Op>
+        inline void executeEnsembleALU( SST::Output& output, const JunoCPUInstruction* inst,
+            JunoEnsembleRegisterFile* regFile, const uint32_t* ctxList, const uint32_t ctxCount ) {
+            
+            const int64_t* left  = regFile->row( inst->getReadReg1() );
+            const int64_t* right = regFile->row( (JUNO_NOT == inst->getInstCode()) ? inst->getReadReg1() : inst->getReadReg2() );
+            int64_t* result      = regFile->row( inst->getWriteReg() );
+            
+            for( uint32_t i = 0; i < ctxCount; ++i ) {
+                const uint32_t ctx = ctxList[i];
+                
+                JUNO_VERBOSE(output, 4, "Context %" PRIu32 " op %" PRIu8 "[r%3" PRIu8 ", r%3" PRIu8 ", res=r%3" PRIu8 "]\n",
+                               ctx, inst->getInstCode(), inst->getReadReg1(), inst->getReadReg2(), inst->getWriteReg());
+                
+                result[ctx] = Op::apply( left[ctx], right[ctx] );
+            }
+        };
+        
+    }
+}
+
+#endif
@@ -0,0 +1,145 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_ENSEMBLE_REG_FILE_
+#define _H_SST_JUNO_ENSEMBLE_REG_FILE_
+
+#include <cinttypes>
+#include <cstdlib>
+#include "junoverbose.h"
+
+namespace SST {
+namespace Juno {
+
+// Register files of every context in a JunoEnsemble, held structure of
+// arrays: row r holds register r of each context next to each other so an
+// operation applied to many contexts is a loop over contiguous values.
+// Rows are padded to whole cache lines. Register numbers are validated at
+// decode (JunoEnsemble::validateInstruction) and not checked here.
+class JunoEnsembleRegisterFile {
+
+public:
+	JunoEnsembleRegisterFile( SST::Output* out, const int regCount, const uint32_t contextCount,
+		const uint64_t dynDataStart ) :
+
+		output(out), maxReg(regCount), contexts(contextCount), dynDataLoc(dynDataStart) {
+
+		output->verbose(CALL_INFO, 2, 0, "Creating %d registers for each of %" PRIu32 " contexts...\n",
+			regCount, contextCount);
+
+		rowCount = static_cast<size_t>( (regCount < 2) ? 2 : regCount );
+		stride   = (static_cast<size_t>( contextCount ) + 7) & ~static_cast<size_t>(7);
+
+		void* regBase     = NULL;
+		void* pendingBase = NULL;
+
+		if( 0 != posix_memalign( &regBase, 64, sizeof(int64_t) * rowCount * stride ) ||
+			0 != posix_memalign( &pendingBase, 64, sizeof(uint8_t) * rowCount * stride ) ) {
+			output->fatal(CALL_INFO, -1, "Error: unable to allocate %d registers for %" PRIu32 " contexts\n",
+				regCount, contextCount);
+		}
+
+		registers = static_cast<int64_t*>( regBase );
+		pending   = static_cast<uint8_t*>( pendingBase );
+		clear();
+	}
+
+	~JunoEnsembleRegisterFile() {
+		free(registers);
+		free(pending);
+	}
+
+	void clear() {
+		for( size_t i = 0; i < rowCount * stride; ++i ) {
+			registers[i] = 0;
+			pending[i]   = 0;
+		}
+
+		int64_t* dynRow = row(1);
+
+		for( uint32_t ctx = 0; ctx < contexts; ++ctx ) {
+			dynRow[ctx] = static_cast<int64_t>(dynDataLoc);
+		}
+	}
+
+	void printRegisters( const uint32_t ctx ) {
+		for( int i = 0; i < maxReg; ++i ) {
+			output->verbose(CALL_INFO, 2, 0, "Context %" PRIu32 " register [r%06d]: [%" PRId64 "]\n",
+				ctx, i, readReg( ctx, static_cast<uint8_t>(i) ));
+		}
+	}
+
+	int getRegisterCount() const {
+		return maxReg;
+	}
+
+	uint32_t getContextCount() const {
+		return contexts;
+	}
+
+	bool isValidRegister(const uint8_t reg) const {
+		return (reg < 2) || (reg < maxReg);
+	}
+
+	// Register reg of every context, index by context
+	int64_t* row(const uint8_t reg) {
+		return &registers[ static_cast<size_t>(reg) * stride ];
+	}
+
+	const int64_t* row(const uint8_t reg) const {
+		return &registers[ static_cast<size_t>(reg) * stride ];
+	}
+
+	int64_t readReg(const uint32_t ctx, const uint8_t reg) const {
+		return row(reg)[ctx];
+	}
+
+	void writeReg(const uint32_t ctx, const uint8_t reg, const int64_t val) {
+		JUNO_VERBOSE(*output, 16, "Context %" PRIu32 " writing %" PRId64 " into register %" PRIu8 "...\n",
+			ctx, val, reg);
+		row(reg)[ctx] = val;
+	}
+
+	// Scoreboard, a register is pending while a load into it is in flight
+	bool isPending(const uint32_t ctx, const uint8_t reg) const {
+		return 0 != pending[ (static_cast<size_t>(reg) * stride) + ctx ];
+	}
+
+	void setPending(const uint32_t ctx, const uint8_t reg) {
+		pending[ (static_cast<size_t>(reg) * stride) + ctx ] = 1;
+	}
+
+	void clearPending(const uint32_t ctx, const uint8_t reg) {
+		pending[ (static_cast<size_t>(reg) * stride) + ctx ] = 0;
+	}
+
+protected:
+	SST::Output* output;
+	const int maxReg;
+	const uint32_t contexts;
+	uint64_t dynDataLoc;
+	size_t rowCount;
+	size_t stride;
+	int64_t* registers;
+	uint8_t* pending;
+
+};
+
+}
+}
+
+#endif
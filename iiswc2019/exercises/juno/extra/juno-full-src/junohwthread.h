@@ -0,0 +1,78 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_HW_THREAD
+#define _H_SST_JUNO_HW_THREAD
+
+#include <cinttypes>
+
+#include "junoregfile.h"
+#include "junoldstunit.h"
+#include "custominst/junocustinst.h"
+
+namespace SST {
+    namespace Juno {
+
+        // How JunoCPU picks the thread to issue from when several are ready
+        enum JunoFetchPolicy {
+            // The next ready thread after the one which issued last
+            JUNO_FETCH_ROUND_ROBIN = 0,
+            // The ready thread with the fewest loads in flight, ties go
+            // round-robin
+            JUNO_FETCH_ICOUNT
+        };
+
+        // Architectural state of one hardware thread of a JunoCPU. The
+        // thread which issues is swapped into the CPU's pc, regFile and
+        // ldStUnit so instruction execution is the same as single threaded.
+        class JunoHardwareThread {
+
+        public:
+            JunoHardwareThread() :
+                pc(0), regFile(NULL), ldStUnit(NULL), cyclesLeft(0), waitingOn(NULL),
+                halted(false), stalled(false), instructions(0), stallCycles(0),
+                instructionsTotal(0), stallCyclesTotal(0), statInstructions(NULL), statStallCycles(NULL) {}
+
+            uint64_t pc;
+            JunoRegisterFile* regFile;
+            JunoLoadStoreUnit* ldStUnit;
+
+            // Cycles until the thread's last operation is done
+            SST::Cycle_t cyclesLeft;
+            // Handler holding this thread's issue until it completes
+            JunoCustomInstructionHandler* waitingOn;
+            bool halted;
+            // Could not issue this cycle for a pending register, the memory
+            // system or a busy handler
+            bool stalled;
+
+            // Local counters, pushed into the statistics with the CPU's
+            uint64_t instructions;
+            uint64_t stallCycles;
+            // Kept across flushes for the IPC report at finish
+            uint64_t instructionsTotal;
+            uint64_t stallCyclesTotal;
+
+            Statistic<uint64_t>* statInstructions;
+            Statistic<uint64_t>* statStallCycles;
+
+        };
+
+    }
+}
+
+#endif
@@ -27,11 +27,14 @@ namespace SST {
             
         public:
             JunoInstructionMgr() {}
-            ~JunoInstructionMgr() {}
+            virtual ~JunoInstructionMgr() {}
             
-            virtual JunoCPUInstruction* getInstruction( const uint64_t addr ) = 0;
+            virtual const JunoCPUInstruction& getInstruction( const uint64_t addr ) = 0;
             virtual bool instReady( const uint64_t addr ) = 0;
             
+            // Called when the program stores over its own instructions
+            virtual void updateText( const uint64_t addr, const uint8_t* data, const uint64_t len ) {}
+            
         };
         
     }
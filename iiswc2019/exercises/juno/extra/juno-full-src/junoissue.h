@@ -0,0 +1,118 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_ISSUE
+#define _H_SST_JUNO_ISSUE
+
+#include <cinttypes>
+#include <vector>
+
+#include "junodispatch.h"
+
+// Widest issue-width accepted, sizes the per-cycle issue counters
+#define JUNO_MAX_ISSUE_WIDTH 8
+
+namespace SST {
+    namespace Juno {
+
+        // Functional unit classes used by the multi-issue model
+        enum JunoUnitClass {
+            JUNO_UNIT_NONE = 0,
+            JUNO_UNIT_ALU,
+            JUNO_UNIT_MULDIV,
+            JUNO_UNIT_LSU,
+            JUNO_UNIT_CUSTOM,
+            JUNO_UNIT_COUNT
+        };
+
+        inline JunoUnitClass junoUnitFor( const JunoDispatchKind kind ) {
+            switch( kind ) {
+            case JUNO_DISPATCH_ADD:
+            case JUNO_DISPATCH_SUB:
+            case JUNO_DISPATCH_AND:
+            case JUNO_DISPATCH_OR:
+            case JUNO_DISPATCH_XOR:
+            case JUNO_DISPATCH_NOT:
+                return JUNO_UNIT_ALU;
+            case JUNO_DISPATCH_MUL:
+            case JUNO_DISPATCH_DIV:
+            case JUNO_DISPATCH_MOD:
+                return JUNO_UNIT_MULDIV;
+            case JUNO_DISPATCH_LOAD:
+            case JUNO_DISPATCH_LOAD_ADDR:
+            case JUNO_DISPATCH_STORE:
+            case JUNO_DISPATCH_VLOAD:
+            case JUNO_DISPATCH_VGATHER:
+            case JUNO_DISPATCH_VSTORE:
+                return JUNO_UNIT_LSU;
+            case JUNO_DISPATCH_CUSTOM:
+                return JUNO_UNIT_CUSTOM;
+            default:
+                return JUNO_UNIT_NONE;
+            }
+        }
+
+        // A set of identical units, each unit accepts a new operation once
+        // the cycle it is reserved until has passed
+        class JunoUnitPool {
+
+        public:
+            JunoUnitPool() {}
+
+            void resize( const uint32_t units ) {
+                busyUntil.assign( units, 0 );
+            }
+
+            uint32_t size() const {
+                return static_cast<uint32_t>( busyUntil.size() );
+            }
+
+            // Index of a unit free at cycle now, or -1 if all are busy
+            int findFree( const SST::Cycle_t now ) const {
+                for( size_t i = 0; i < busyUntil.size(); ++i ) {
+                    if( busyUntil[i] <= now ) {
+                        return static_cast<int>(i);
+                    }
+                }
+
+                return -1;
+            }
+
+            // Earliest cycle at which some unit is free
+            SST::Cycle_t nextFree() const {
+                SST::Cycle_t earliest = busyUntil.empty() ? 0 : busyUntil[0];
+
+                for( size_t i = 1; i < busyUntil.size(); ++i ) {
+                    earliest = (busyUntil[i] < earliest) ? busyUntil[i] : earliest;
+                }
+
+                return earliest;
+            }
+
+            void reserve( const int unit, const SST::Cycle_t until ) {
+                busyUntil[unit] = until;
+            }
+
+        protected:
+            std::vector<SST::Cycle_t> busyUntil;
+
+        };
+
+    }
+}
+
+#endif
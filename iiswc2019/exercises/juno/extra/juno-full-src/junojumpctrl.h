@@ -22,11 +22,12 @@
 
 #include "junocpuinst.h"
 #include "junoregfile.h"
+#include "junoverbose.h"
 
 namespace SST {
     namespace Juno {
         
-        void executeJumpZero( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile, uint64_t* pc ) {
+        void executeJumpZero( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile, uint64_t* pc ) {
             const uint8_t chkReg    = inst->getReadReg1();
             const int64_t regVal   = regFile->readReg(chkReg);
             
@@ -38,33 +39,33 @@ namespace SST {
                 pcOut = static_cast<uint64_t>( pcI64 + static_cast<int64_t>(pcDiff) );
             }
             
-            output.verbose(CALL_INFO, 4, 0, "JZERO[r%3" PRIu8 ", offset=%" PRId16 "] (%" PRId64 ", pcIn=%" PRId64 ", pcOut=%" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "JZERO[r%3" PRIu8 ", offset=%" PRId16 "] (%" PRId64 ", pcIn=%" PRId64 ", pcOut=%" PRId64 ")\n",
                            chkReg, pcDiff, regVal, (*pc), pcOut);
             
             *pc = pcOut;
         };
         
-        void executeJumpLTZ( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile, uint64_t* pc ) {
+        void executeJumpLTZ( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile, uint64_t* pc ) {
             const uint8_t chkReg    = inst->getReadReg1();
             const int64_t regVal   = regFile->readReg(chkReg);
             
             const int16_t pcDiff   = inst->get16bJumpOffset() * 4;
             const uint64_t pcOut   = static_cast<uint64_t>( (regVal < 0) ? static_cast<int64_t>(*pc) + static_cast<int64_t>(pcDiff) : (*pc) + 4);
             
-            output.verbose(CALL_INFO, 4, 0, "JLTZ[r%3" PRIu8 ", offset=%" PRId16 "] (%" PRId64 ", pcIn=%" PRId64 ", pcOut=%" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "JLTZ[r%3" PRIu8 ", offset=%" PRId16 "] (%" PRId64 ", pcIn=%" PRId64 ", pcOut=%" PRId64 ")\n",
                            chkReg, pcDiff, regVal, (*pc), pcOut);
             
             *pc = pcOut;
         };
         
-        void executeJumpGTZ( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile, uint64_t* pc ) {
+        void executeJumpGTZ( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile, uint64_t* pc ) {
             const uint8_t chkReg    = inst->getReadReg1();
             const int64_t regVal   = regFile->readReg(chkReg);
             
             const int16_t pcDiff   = inst->get16bJumpOffset() * 4;
             const uint64_t pcOut   = static_cast<uint64_t>( (regVal > 0) ? static_cast<int64_t>(*pc) + static_cast<int64_t>(pcDiff) : (*pc) + 4);
             
-            output.verbose(CALL_INFO, 4, 0, "JGTZ[r%3" PRIu8 ", offset=%" PRId16 "] (%" PRId64 ", pcIn=%" PRId64 ", pcOut=%" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "JGTZ[r%3" PRIu8 ", offset=%" PRId16 "] (%" PRId64 ", pcIn=%" PRId64 ", pcOut=%" PRId64 ")\n",
                            chkReg, pcDiff, regVal, (*pc), pcOut);
             
             *pc = pcOut;
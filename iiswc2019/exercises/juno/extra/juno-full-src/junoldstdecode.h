@@ -22,42 +22,85 @@
 
 #include "junocpuinst.h"
 #include "junoregfile.h"
+#include "junoverbose.h"
 
 namespace SST {
     namespace Juno {
         
-        void executeStore( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile,
+        void executeStore( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile,
                           JunoLoadStoreUnit* ldst ) {
             
             const uint8_t valReg  = inst->getReadReg1();
             const uint8_t addrReg = inst->getReadReg2();
             
-            output.verbose(CALL_INFO, 4, 0, "STORE[r%" PRIu8 ", r%" PRIu8 "], (%" PRId64 ", %" PRId64 ")\n",
+            JUNO_VERBOSE(output, 4, "STORE[r%" PRIu8 ", r%" PRIu8 "], (%" PRId64 ", %" PRId64 ")\n",
                            valReg, addrReg,
                            regFile->readReg(valReg), regFile->readReg(addrReg));
             
             ldst->createStoreRequest( static_cast<uint64_t>(regFile->readReg(addrReg)), valReg );
         }
         
-        void executeLoad( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile,
+        void executeLoad( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile,
                          JunoLoadStoreUnit* ldst ) {
             
             const uint8_t targetReg = inst->getWriteReg();
             const uint8_t addrReg   = inst->getReadReg1();
             
-            output.verbose(CALL_INFO, 4, 0, "LOAD[r%5" PRIu8 ", res=r%" PRIu8 "] (%" PRId64 ")\n", targetReg,
+            JUNO_VERBOSE(output, 4, "LOAD[r%5" PRIu8 ", res=r%" PRIu8 "] (%" PRId64 ")\n", targetReg,
                            addrReg, regFile->readReg( addrReg ));
             
             ldst->createLoadRequest( static_cast<uint64_t>(regFile->readReg( addrReg )), targetReg );
             
         };
         
-        void executeLDA( SST::Output& output, JunoCPUInstruction* inst, JunoRegisterFile* regFile, JunoLoadStoreUnit* ldst ) {
+        // Vector forms name a group of registers, the count is held in the
+        // second register field
+        void executeVectorLoad( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile,
+                         JunoLoadStoreUnit* ldst ) {
+
+            const uint8_t baseReg = inst->getWriteReg();
+            const uint8_t count   = inst->getReadReg2();
+            const uint8_t addrReg = inst->getReadReg1();
+
+            JUNO_VERBOSE(output, 4, "VLOAD[r%" PRIu8 ", %" PRIu8 ", r%" PRIu8 "] (%" PRId64 ")\n", baseReg,
+                           count, addrReg, regFile->readReg( addrReg ));
+
+            ldst->createVectorLoadRequest( static_cast<uint64_t>(regFile->readReg( addrReg )), baseReg, count );
+        }
+
+        void executeGather( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile,
+                         JunoLoadStoreUnit* ldst ) {
+
+            const uint8_t baseReg = inst->getWriteReg();
+            const uint8_t count   = inst->getReadReg2();
+            const uint8_t idxReg  = inst->getReadReg1();
+
+            JUNO_VERBOSE(output, 4, "VGATHER[r%" PRIu8 ", %" PRIu8 ", r%" PRIu8 "]\n", baseReg, count, idxReg);
+
+            for( uint8_t i = 0; i < count; ++i ) {
+                ldst->createLoadRequest( static_cast<uint64_t>(regFile->readReg( idxReg + i )), baseReg + i );
+            }
+        }
+
+        void executeVectorStore( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile,
+                          JunoLoadStoreUnit* ldst ) {
+
+            const uint8_t baseReg = inst->getWriteReg();
+            const uint8_t count   = inst->getReadReg2();
+            const uint8_t addrReg = inst->getReadReg1();
+
+            JUNO_VERBOSE(output, 4, "VSTORE[r%" PRIu8 ", %" PRIu8 ", r%" PRIu8 "] (%" PRId64 ")\n", baseReg,
+                           count, addrReg, regFile->readReg( addrReg ));
+
+            ldst->createVectorStoreRequest( static_cast<uint64_t>(regFile->readReg( addrReg )), baseReg, count );
+        }
+
+        void executeLDA( SST::Output& output, const JunoCPUInstruction* inst, JunoRegisterFile* regFile, JunoLoadStoreUnit* ldst ) {
             
             const uint8_t resultReg = inst->getWriteReg();
             const uint16_t addrLit = inst->get16bAbsAddr();
             
-            output.verbose(CALL_INFO, 4, 0, "LDA[%" PRIu16 ", res=r%" PRIu8 "]\n", addrLit, resultReg);
+            JUNO_VERBOSE(output, 4, "LDA[%" PRIu16 ", res=r%" PRIu8 "]\n", addrLit, resultReg);
             
             ldst->createLoadRequest( static_cast<uint64_t>(addrLit), resultReg );
             
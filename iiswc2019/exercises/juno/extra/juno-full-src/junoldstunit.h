@@ -19,9 +19,13 @@
 #define _H_SST_JUNO_LD_ST_UNIT
 
 #include <sst/core/interfaces/simpleMem.h>
-#include <map>
+#include <algorithm>
+#include <vector>
 
+#include "junoopcodes.h"
 #include "junoregfile.h"
+#include "junostorebuffer.h"
+#include "junoverbose.h"
 
 using namespace SST::Interfaces;
 
@@ -31,100 +35,479 @@ namespace SST {
         class JunoLoadStoreEntry {
             
         public:
-            JunoLoadStoreEntry( const SimpleMem::Request::id_t reqID, uint8_t regTgt ) :
-            	id(reqID), regTarget(regTgt) {}
+            JunoLoadStoreEntry() :
+            	id(0), addr(0), regTarget(0), regCount(0), isLoad(false), valid(false) {}
+            
+            JunoLoadStoreEntry( const SimpleMem::Request::id_t reqID, const uint64_t reqAddr, uint8_t regTgt, bool load,
+                const uint8_t regs = 1 ) :
+            	id(reqID), addr(reqAddr), regTarget(regTgt), regCount(regs), isLoad(load), valid(true) {}
             
             ~JunoLoadStoreEntry() {}
             
-            uint8_t getRegister() { return regTarget; }
-            SimpleMem::Request::id_t getID() { return id; }
+            uint8_t getRegister() const { return regTarget; }
+            // Registers from getRegister() the request carries, one word each
+            uint8_t getRegisterCount() const { return regCount; }
+            SimpleMem::Request::id_t getID() const { return id; }
+            uint64_t getAddress() const { return addr; }
+            bool isLoadEntry() const { return isLoad; }
+            bool isValid() const { return valid; }
             
         protected:
             SimpleMem::Request::id_t id;
+            uint64_t addr;
             uint8_t regTarget;
+            uint8_t regCount;
+            bool isLoad;
+            bool valid;
             
         };
         
         class JunoLoadStoreUnit {
             
         public:
-            JunoLoadStoreUnit( SST::Output* out, SimpleMem* smMem, JunoRegisterFile* rFile, const uint64_t maxAddress ) :
-            output(out), mem(smMem), regFile(rFile), maxAddr(maxAddress) {}
+            JunoLoadStoreUnit( SST::Output* out, SimpleMem* smMem, JunoRegisterFile* rFile, const uint64_t maxAddress,
+                const uint32_t maxLoads, JunoStoreBuffer* sb, const uint64_t lineBytes ) :
+            output(out), mem(smMem), regFile(rFile), storeBuffer(sb), maxAddr(maxAddress), lineSize(lineBytes),
+            maxOutstandingLoads(maxLoads), loadsInFlight(0), storesInFlight(0), evictedOnStall(false), entryCount(0) {
+            
+                // Loads may go past the limit only into an idle unit, so
+                // the most requests in flight is the larger of the limit and
+                // what one vector instruction needs. Stores without a store
+                // buffer only issue into an empty table.
+                const uint64_t vectorLines = (static_cast<uint64_t>(JUNO_VECTOR_MAX_REGS) * 8 + lineSize - 1) / lineSize + 1;
+                const uint64_t perInst = std::max( static_cast<uint64_t>(JUNO_VECTOR_MAX_REGS), vectorLines );
+                
+                sizeTable( std::max( static_cast<uint64_t>( maxLoads ), perInst ) );
+                pendingLoads.reserve( capacity );
+            }
             
             bool operationsPending() {
-                return pending.size() > 0;
+                return (entryCount > 0) || (NULL != storeBuffer && ! storeBuffer->empty());
             }
             
-            void createLoadRequest( uint64_t addr, uint8_t reg ) {
-                output->verbose(CALL_INFO, 16, 0, "Creating a load from address: %" PRIu64 " into register: %" PRIu8 "\n",
-                                addr, reg);
-
+            // Requests sent to memory and not yet answered, stores held in
+            // the store buffer are not counted
+            bool requestsPending() const {
+                return entryCount > 0;
+            }
+            
+            uint32_t loadsPending() const {
+                return loadsInFlight;
+            }
+            
+            // Loads may overlap each other but are held back by an
+            // outstanding store so they cannot pass it in memory. With a
+            // store buffer only stores to the same bytes hold a load back,
+            // a load which would need bytes from both the buffer and memory
+            // pushes the line out and waits for it.
+            bool canIssueLoad( const uint64_t addr, const uint64_t len = 8 ) {
+                const uint32_t requests = requestsFor( addr, len );
+                
+                if( ! loadSlotsFree( requests ) || ! tableHasRoom( requests ) ) {
+                    return false;
+                }
+                
+                if( NULL == storeBuffer ) {
+                    return 0 == storesInFlight;
+                }
+                
+                if( JUNO_SB_CONFLICT == storeBuffer->forward( addr, len, NULL ) ) {
+                    storeBuffer->flush( addr, len );
+                    return false;
+                }
+                
+                return true;
+            }
+            
+            // A gather of count words from the addresses held in the
+            // registers from idxReg, every element takes a load slot
+            bool canIssueGather( const uint8_t idxReg, const uint8_t count ) {
+                if( ! loadSlotsFree( count ) || ! tableHasRoom( count ) ) {
+                    return false;
+                }
+                
+                if( NULL == storeBuffer ) {
+                    return 0 == storesInFlight;
+                }
+                
+                bool conflict = false;
+                
+                for( uint8_t i = 0; i < count; ++i ) {
+                    const uint64_t addr = static_cast<uint64_t>( regFile->readReg( idxReg + i ) );
+                    
+                    if( JUNO_SB_CONFLICT == storeBuffer->forward( addr, 8, NULL ) ) {
+                        storeBuffer->flush( addr, 8 );
+                        conflict = true;
+                    }
+                }
+                
+                return ! conflict;
+            }
+            
+            bool canIssueStore( const uint64_t addr, const uint64_t len = 8 ) {
+                evictedOnStall = false;
+                
+                if( NULL == storeBuffer ) {
+                    return 0 == entryCount;
+                }
+                
+                // An older load to these bytes must not see this store
+                if( loadPendingTo( addr, len ) ) {
+                    return false;
+                }
+                
+                // Only a full buffer needs a line pushed out, a line being
+                // written frees up when its response arrives
+                if( ! storeBuffer->canAccept( addr, len ) ) {
+                    if( ! storeBuffer->isWriting( addr, len ) ) {
+                        evictedOnStall = storeBuffer->evictOldest();
+                    }
+                    
+                    return false;
+                }
+                
+                return true;
+            }
+            
+            // True if the last refused store wrote a line out to make room,
+            // checking again next cycle would write out another one
+            bool stallMakesProgress() const {
+                return evictedOnStall;
+            }
+            
+            // Push any buffered stores out to memory, used before an
+            // instruction which has to wait for the memory system to drain
+            void flushStores() {
+                if( NULL != storeBuffer ) {
+                    storeBuffer->flushAll();
+                }
+            }
+            
+            void checkAddress( const uint64_t addr ) const {
 		if( addr >= maxAddr ) {
 			output->fatal(CALL_INFO, -1, "Address requested: %" PRIu64 " but maximum address is: %" PRIu64 "\n",
 				addr, maxAddr);
 		}
+            }
+            
+            void createLoadRequest( uint64_t addr, uint8_t reg ) {
+                JUNO_VERBOSE(*output, 16, "Creating a load from address: %" PRIu64 " into register: %" PRIu8 "\n",
+                                addr, reg);
+
+                checkAddress( addr );
+                
+                if( NULL != storeBuffer ) {
+                    int64_t value = 0;
+                    
+                    if( JUNO_SB_HIT == storeBuffer->forward( addr, 8, reinterpret_cast<uint8_t*>( &value ) ) ) {
+                        JUNO_VERBOSE(*output, 16, "Load from address: %" PRIu64 " forwarded from the store buffer\n", addr);
+                        storeBuffer->recordForward();
+                        regFile->writeReg( reg, value );
+                        return;
+                    }
+                }
                 
                 SimpleMem::Request* req = new SimpleMem::Request(SimpleMem::Request::Read, addr, 8);
                 
-                JunoLoadStoreEntry* entry = new JunoLoadStoreEntry( req->id, reg );
-                addEntry( entry );
+                addEntry( JunoLoadStoreEntry( req->id, addr, reg, true ) );
+                
+                regFile->setPending( reg );
+                loadsInFlight++;
                 
                 mem->sendRequest( req );
             }
             
+            // Load count consecutive words from addr into the registers from
+            // reg, one request per line the words fall in
+            void createVectorLoadRequest( const uint64_t addr, const uint8_t reg, const uint8_t count ) {
+                const uint64_t len = static_cast<uint64_t>(count) * 8;
+                
+                JUNO_VERBOSE(*output, 16, "Creating a vector load of %" PRIu8 " words from address: %" PRIu64 " into registers from: %" PRIu8 "\n",
+                                count, addr, reg);
+                
+                checkAddress( addr );
+                checkAddress( addr + len - 8 );
+                
+                if( NULL != storeBuffer ) {
+                    int64_t values[JUNO_VECTOR_MAX_REGS];
+                    
+                    if( JUNO_SB_HIT == storeBuffer->forward( addr, len, reinterpret_cast<uint8_t*>( values ) ) ) {
+                        JUNO_VERBOSE(*output, 16, "Vector load from address: %" PRIu64 " forwarded from the store buffer\n", addr);
+                        storeBuffer->recordForward();
+                        
+                        for( uint8_t i = 0; i < count; ++i ) {
+                            regFile->writeReg( reg + i, values[i] );
+                        }
+                        
+                        return;
+                    }
+                }
+                
+                for( uint8_t first = 0; first < count; ) {
+                    const uint64_t chunkAddr = addr + static_cast<uint64_t>(first) * 8;
+                    const uint8_t words = wordsInLine( chunkAddr, count - first );
+                    
+                    SimpleMem::Request* req = new SimpleMem::Request(SimpleMem::Request::Read, chunkAddr, static_cast<uint64_t>(words) * 8);
+                    
+                    addEntry( JunoLoadStoreEntry( req->id, chunkAddr, reg + first, true, words ) );
+                    
+                    for( uint8_t i = 0; i < words; ++i ) {
+                        regFile->setPending( reg + first + i );
+                    }
+                    
+                    loadsInFlight++;
+                    first += words;
+                    
+                    mem->sendRequest( req );
+                }
+            }
+            
+            // Store the registers from reg to count consecutive words at
+            // addr, through the store buffer or one request per line
+            void createVectorStoreRequest( const uint64_t addr, const uint8_t reg, const uint8_t count ) {
+                const uint64_t len = static_cast<uint64_t>(count) * 8;
+                
+                JUNO_VERBOSE(*output, 16, "Creating a vector store of %" PRIu8 " registers from %" PRIu8 " to address: %" PRIu64 "...\n",
+                                count, reg, addr);
+                
+                checkAddress( addr );
+                checkAddress( addr + len - 8 );
+                
+                int64_t values[JUNO_VECTOR_MAX_REGS];
+                
+                for( uint8_t i = 0; i < count; ++i ) {
+                    values[i] = regFile->readReg( reg + i );
+                }
+                
+                if( NULL != storeBuffer ) {
+                    storeBuffer->insert( addr, reinterpret_cast<const uint8_t*>( values ), len );
+                    return;
+                }
+                
+                for( uint8_t first = 0; first < count; ) {
+                    const uint64_t chunkAddr = addr + static_cast<uint64_t>(first) * 8;
+                    const uint8_t words = wordsInLine( chunkAddr, count - first );
+                    
+                    SimpleMem::Request* req = new SimpleMem::Request(SimpleMem::Request::Write, chunkAddr, static_cast<uint64_t>(words) * 8);
+                    
+                    std::vector<uint8_t> payload;
+                    payload.resize( static_cast<size_t>(words) * 8 );
+                    
+                    memcpy( (void*) &payload[0], (void*) &values[first], payload.size() );
+                    req->setPayload( payload );
+                    
+                    addEntry( JunoLoadStoreEntry( req->id, chunkAddr, reg + first, false, words ) );
+                    
+                    storesInFlight++;
+                    first += words;
+                    
+                    mem->sendRequest( req );
+                }
+            }
+            
             void createStoreRequest( uint64_t addr, uint8_t reg ) {
-                output->verbose(CALL_INFO, 16, 0, "Creating a store from register %" PRIu8 " to address: %" PRIu64 "...\n",
+                JUNO_VERBOSE(*output, 16, "Creating a store from register %" PRIu8 " to address: %" PRIu64 "...\n",
                                 reg, addr);
 
-		if( addr >= maxAddr ) {
-			output->fatal(CALL_INFO, -1, "Address requested: %" PRIu64 " but maximum address is: %" PRIu64 "\n",
-				addr, maxAddr);
-		}
+                checkAddress( addr );
+                
+                int64_t regValue = regFile->readReg( reg );
+                
+                if( NULL != storeBuffer ) {
+                    storeBuffer->insert( addr, reinterpret_cast<const uint8_t*>( &regValue ), sizeof(regValue) );
+                    return;
+                }
                 
                 SimpleMem::Request* req = new SimpleMem::Request(SimpleMem::Request::Write, addr, 8);
                 
                 std::vector<uint8_t> payload;
                 payload.resize(8);
-                int64_t regValue = regFile->readReg( reg );
                 
                 memcpy( (void*) &payload[0], (void*) &regValue, sizeof(regValue) );
                 req->setPayload( payload );
                 
-                JunoLoadStoreEntry* entry = new JunoLoadStoreEntry( req->id, reg );
-                addEntry( entry );
+                addEntry( JunoLoadStoreEntry( req->id, addr, reg, false ) );
+                
+                storesInFlight++;
                 
                 mem->sendRequest( req );
             }
             
-            void addEntry( JunoLoadStoreEntry* entry ) {
-                pending.insert( std::pair<SimpleMem::Request::id_t, JunoLoadStoreEntry*>( entry->getID(), entry ) );
+            void addEntry( const JunoLoadStoreEntry& entry ) {
+                // Issue stalls before the table fills, only a custom handler
+                // sending more requests than the table holds gets here
+                if( ! tableHasRoom( 1 ) ) {
+                    output->fatal(CALL_INFO, -1, "Error: load/store table is full (%" PRIu64 " requests in flight)\n", capacity);
+                }
+                
+                uint64_t slot = hashID( entry.getID() );
+                
+                while( table[slot].isValid() ) {
+                    slot = (slot + 1) & tableMask;
+                }
+                
+                table[slot] = entry;
+                entryCount++;
+                
+                if( entry.isLoadEntry() ) {
+                    pendingLoads.push_back( entry );
+                }
             }
             
-            uint8_t lookupEntry( SimpleMem::Request::id_t id ) {
-                auto entry = pending.find( id );
+            const JunoLoadStoreEntry& lookupEntry( SimpleMem::Request::id_t id ) {
+                const uint64_t slot = findSlot( id );
                 
-                if( entry == pending.end() ) {
+                if( slot == tableNotFound() ) {
                     fprintf(stderr, "Error: response from memory could not be found.\n");
                     exit(-1);
                 }
                 
-                return entry->second->getRegister();
+                return table[slot];
             }
-            
+
+            // True if the response with this ID answers a request of this
+            // unit, used to route responses between hardware threads
+            bool ownsRequest( SimpleMem::Request::id_t id ) const {
+                return findSlot( id ) != tableNotFound();
+            }
+
             void removeEntry( SimpleMem::Request::id_t id ) {
-                auto entry = pending.find( id );
+                uint64_t slot = findSlot( id );
+                
+                if( slot == tableNotFound() ) {
+                    if( NULL != storeBuffer ) {
+                        storeBuffer->handleResponse( id );
+                    }
+                    
+                    return;
+                }
                 
-                if( entry != pending.end() ) {
-                    pending.erase(entry);
+                if( table[slot].isLoadEntry() ) {
+                    for( uint8_t i = 0; i < table[slot].getRegisterCount(); ++i ) {
+                        regFile->clearPending( table[slot].getRegister() + i );
+                    }
+                    
+                    for( size_t i = 0; i < pendingLoads.size(); ++i ) {
+                        if( pendingLoads[i].getID() == id ) {
+                            pendingLoads[i] = pendingLoads.back();
+                            pendingLoads.pop_back();
+                            break;
+                        }
+                    }
+                    
+                    loadsInFlight--;
+                } else {
+                    storesInFlight--;
+                }
+                
+                table[slot] = JunoLoadStoreEntry();
+                entryCount--;
+                
+                // Backward shift deletion, pull later entries of the probe
+                // run into the hole so lookups never need tombstones
+                uint64_t next = (slot + 1) & tableMask;
+                
+                while( table[next].isValid() ) {
+                    const uint64_t home = hashID( table[next].getID() );
+                    
+                    if( ((next - home) & tableMask) >= ((next - slot) & tableMask) ) {
+                        table[slot] = table[next];
+                        table[next] = JunoLoadStoreEntry();
+                        slot = next;
+                    }
+                    
+                    next = (next + 1) & tableMask;
                 }
             }
             
         private:
+            uint64_t hashID( const SimpleMem::Request::id_t id ) const {
+                return (static_cast<uint64_t>(id) * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - tableBits);
+            }
+            
+            // Loads needing several requests may always issue into an idle
+            // unit, they would otherwise never issue with a small limit
+            bool loadSlotsFree( const uint32_t needed ) const {
+                return (0 == loadsInFlight) || ((loadsInFlight + needed) <= maxOutstandingLoads);
+            }
+            
+            bool tableHasRoom( const uint64_t needed ) const {
+                return (entryCount + needed) <= capacity;
+            }
+            
+            uint32_t requestsFor( const uint64_t addr, const uint64_t len ) const {
+                return static_cast<uint32_t>( ((addr + len - 1) / lineSize) - (addr / lineSize) ) + 1;
+            }
+            
+            // Whole words from addr up to the end of its line, at most count.
+            // A word straddling the line goes on its own like a scalar access.
+            uint8_t wordsInLine( const uint64_t addr, const uint8_t count ) const {
+                const uint64_t lineEnd = ((addr / lineSize) + 1) * lineSize;
+                const uint64_t words   = (lineEnd - addr) / 8;
+                
+                return static_cast<uint8_t>( std::max( static_cast<uint64_t>(1), std::min( words, static_cast<uint64_t>(count) ) ) );
+            }
+            
+            bool loadPendingTo( const uint64_t addr, const uint64_t len ) const {
+                for( size_t i = 0; i < pendingLoads.size(); ++i ) {
+                    const uint64_t loadLen = static_cast<uint64_t>( pendingLoads[i].getRegisterCount() ) * 8;
+                    
+                    if( (pendingLoads[i].getAddress() < addr + len) && (addr < pendingLoads[i].getAddress() + loadLen) ) {
+                        return true;
+                    }
+                }
+                
+                return false;
+            }
+            
+            static uint64_t tableNotFound() {
+                return UINT64_MAX;
+            }
+            
+            uint64_t findSlot( const SimpleMem::Request::id_t id ) const {
+                for( uint64_t slot = hashID( id ); table[slot].isValid(); slot = (slot + 1) & tableMask ) {
+                    if( table[slot].getID() == id ) {
+                        return slot;
+                    }
+                }
+                
+                return tableNotFound();
+            }
+            
+            // Kept at most half full so probe sequences stay short
+            void sizeTable( const uint64_t maxEntries ) {
+                capacity  = maxEntries;
+                tableBits = 1;
+                
+                while( (static_cast<uint64_t>(1) << tableBits) < (capacity * 2) ) {
+                    tableBits++;
+                }
+                
+                tableMask = (static_cast<uint64_t>(1) << tableBits) - 1;
+                table.resize( tableMask + 1 );
+            }
+            
             SST::Output* output;
             SimpleMem* mem;
             JunoRegisterFile* regFile;
-            std::map<SimpleMem::Request::id_t, JunoLoadStoreEntry*> pending;
+            JunoStoreBuffer* storeBuffer;
             uint64_t maxAddr;
+            // Vector requests are split so none crosses a line
+            uint64_t lineSize;
+            uint32_t maxOutstandingLoads;
+            uint32_t loadsInFlight;
+            uint32_t storesInFlight;
+            bool evictedOnStall;
+            
+            // Open addressed on the request ID, sized once from the
+            // outstanding request limit
+            std::vector<JunoLoadStoreEntry> table;
+            // Loads in flight, packed so stores only check these
+            std::vector<JunoLoadStoreEntry> pendingLoads;
+            uint64_t entryCount;
+            uint64_t capacity;
+            uint64_t tableMask;
+            uint32_t tableBits;
         };
         
     }
@@ -21,8 +21,15 @@
 #define JUNO_NOOP          0
 #define JUNO_LOAD          1
 #define JUNO_LOAD_ADDR     2
+#define JUNO_VLOAD         3
+#define JUNO_VGATHER       4
 #define JUNO_STORE         8
 #define JUNO_STORE_ADDR    9
+#define JUNO_VSTORE        10
+
+// Registers moved by one VLOAD, VGATHER or VSTORE, the count is encoded
+// in the second register field
+#define JUNO_VECTOR_MAX_REGS 8
 
 #define JUNO_ADD           16
 #define JUNO_SUB           17
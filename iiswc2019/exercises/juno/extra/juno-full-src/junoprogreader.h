@@ -21,17 +21,121 @@
 #include <cstdio>
 #include <cinttypes>
 #include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Data then text, stored byte for byte
+#define JUNO_BINARY_DENSE  1000000
+// Only the initialized extents of the data are stored, the rest of the
+// data (BSS) reads as zero
+#define JUNO_BINARY_SPARSE 1000001
+// A section table follows the header, symbol and source line tables
+// travel with the program
+#define JUNO_BINARY_SECTIONED 2000000
+
+#define JUNO_SECTION_TEXT    1
+#define JUNO_SECTION_DATA    2
+#define JUNO_SECTION_BSS     3
+#define JUNO_SECTION_SYMBOLS 4
+#define JUNO_SECTION_LINES   5
+
+#define JUNO_SYMBOL_CODE 0
+#define JUNO_SYMBOL_DATA 1
+
+// Bytes in each section table entry and each symbol table entry
+#define JUNO_SECTION_ENTRY_LEN 32
+#define JUNO_SYMBOL_ENTRY_LEN  16
+
+// Zero runs at least this long are left out of the initialized extents
+#define JUNO_MIN_ZERO_RUN  64
 
 namespace SST {
     namespace Juno {
-        
+
+        // Initialized bytes of the program image, pointing into the binary
+        struct JunoProgramExtent {
+            uint64_t addr;
+            uint64_t length;
+            const char* bytes;
+        };
+
+        // The binary is mapped read-only and shared by everything which
+        // needs the image (instruction manager, shadow memory and init)
+        // rather than being copied into a private buffer.
+        //
+        // A sparse binary (JUNO_BINARY_SPARSE) follows the header with an
+        // extent count, a table of (address, length) pairs, the extent bytes
+        // and then the text.
+        //
+        // A sectioned binary (JUNO_BINARY_SECTIONED) follows the header with
+        // a section count and a table of (type, reserved, address, file
+        // offset, size) entries. Symbols and source lines are optional and
+        // are only used to describe addresses in diagnostics.
         class JunoProgramReader {
             
         public:
-            JunoProgramReader( FILE* appBinary, SST::Output* output ) {
-                fread( (void*) &binVersion, sizeof(binVersion), 1, appBinary );
-                fread( (void*) &dataLen, sizeof(dataLen), 1, appBinary );
-                fread( (void*) &instLen, sizeof(instLen), 1, appBinary );
+            JunoProgramReader( FILE* appBinary, SST::Output* output ) :
+            	mapBase(NULL), mapLength(0), readBuffer(NULL), textBinary(NULL),
+            	symbolTable(NULL), symbolCount(0), symbolNames(NULL), symbolNamesLen(0),
+            	lineTable(NULL), lineCount(0) {
+
+                const int64_t headerLen = sizeof(binVersion) + sizeof(dataLen) + sizeof(instLen);
+                struct stat binStat;
+
+                if( 0 != fstat( fileno(appBinary), &binStat ) ) {
+                    output->fatal(CALL_INFO, -1, "Error: unable to query the program binary\n");
+                }
+
+                if( S_ISREG( binStat.st_mode ) ) {
+                    mapLength = static_cast<size_t>( binStat.st_size );
+                    mapBase   = (mapLength > 0) ?
+                        mmap( NULL, mapLength, PROT_READ, MAP_PRIVATE, fileno(appBinary), 0 ) : MAP_FAILED;
+                } else {
+                    mapBase = MAP_FAILED;
+                }
+
+                const char* fileImage = NULL;
+
+                if( MAP_FAILED == mapBase ) {
+                    // Not everything can be mapped (pipes for instance),
+                    // fall back to reading the whole stream
+                    output->verbose(CALL_INFO, 1, 0, "Unable to map program binary, reading it instead\n");
+
+                    mapBase   = NULL;
+                    mapLength = 0;
+
+                    size_t capacity = 0;
+                    size_t bytesRead = 0;
+
+                    do {
+                        if( mapLength == capacity ) {
+                            capacity   = (0 == capacity) ? 65536 : (capacity * 2);
+                            readBuffer = (char*) realloc( readBuffer, capacity );
+
+                            if( NULL == readBuffer ) {
+                                output->fatal(CALL_INFO, -1, "Error: unable to allocate memory for the program binary\n");
+                            }
+                        }
+
+                        bytesRead  = fread( (void*) &readBuffer[mapLength], sizeof(char), capacity - mapLength, appBinary );
+                        mapLength += bytesRead;
+                    } while( bytesRead > 0 );
+
+                    fileImage = readBuffer;
+                } else {
+                    fileImage = static_cast<const char*>( mapBase );
+                }
+
+                if( mapLength < static_cast<size_t>( headerLen ) ) {
+                    output->fatal(CALL_INFO, -1, "Error: unable to read the program header, file is too short\n");
+                }
+
+                memcpy( (void*) &binVersion, &fileImage[0], sizeof(binVersion) );
+                memcpy( (void*) &dataLen, &fileImage[sizeof(binVersion)], sizeof(dataLen) );
+                memcpy( (void*) &instLen, &fileImage[sizeof(binVersion) + sizeof(dataLen)], sizeof(instLen) );
 
 		padding = 0;
 
@@ -44,25 +148,47 @@ namespace SST {
                 output->verbose(CALL_INFO, 1, 0, "Inst Length:              %" PRIu64 "\n", instLen);
 		output->verbose(CALL_INFO, 1, 0, "Padding                   %" PRIu64 "\n", padding);
 
-                programBinary = (char*) malloc( sizeof(char) * (dataLen + instLen + padding));
+                if( JUNO_BINARY_DENSE == binVersion ) {
+                    if( (mapLength - headerLen) < (dataLen + instLen) ) {
+                        output->fatal(CALL_INFO, -1, "Error: program binary is truncated, expected %" PRIu64 " bytes of data and text but found %" PRIu64 "\n",
+                            dataLen + instLen, static_cast<uint64_t>( mapLength - headerLen ));
+                    }
 
-		for( uint64_t i = 0; i < (dataLen + instLen + padding); ++i ) {
-			programBinary[i] = 0;
-		}
+                    addExtent( 0, &fileImage[headerLen], dataLen );
+                    textBinary = &fileImage[headerLen + dataLen];
+                } else if( JUNO_BINARY_SPARSE == binVersion ) {
+                    readSparseData( fileImage, headerLen, output );
+                } else if( JUNO_BINARY_SECTIONED == binVersion ) {
+                    readSections( fileImage, headerLen, output );
+                } else {
+                    output->fatal(CALL_INFO, -1, "Error: program binary version %" PRId64 " is not supported\n", binVersion);
+                }
 
-                fread( (void*) programBinary, sizeof(char), (dataLen + instLen), appBinary );
+                uint64_t initBytes = 0;
 
-                for( uint64_t i = 0; i < dataLen; i += 8 ) {
-                    int64_t tmp = 0;
-                    memcpy( (void*) &tmp, (void*) &programBinary[i], sizeof(tmp) );
+                for( size_t i = 0; i < extents.size(); ++i ) {
+                    initBytes += extents[i].length;
 
-                    output->verbose(CALL_INFO, 2, 0, " -> %8" PRIu64 " : %" PRId64 "\n", i, tmp );
+                    output->verbose(CALL_INFO, 2, 0, " -> extent %8" PRIu64 " : %" PRIu64 " bytes\n",
+                        extents[i].addr, extents[i].length );
                 }
 
+                output->verbose(CALL_INFO, 1, 0, "Initialized Data:         %" PRIu64 " bytes in %" PRIu64 " extents\n",
+                    initBytes, static_cast<uint64_t>( extents.size() ));
+
+                // Text is always sent whole, after the data
+                if( instLen > 0 ) {
+                    JunoProgramExtent textExtent = { dataLen, instLen, textBinary };
+                    extents.push_back( textExtent );
+                }
             }
 
             ~JunoProgramReader() {
-                free( programBinary );
+                if( NULL != mapBase ) {
+                    munmap( mapBase, mapLength );
+                }
+
+                free( readBuffer );
             }
 
             int64_t getBinaryVersion() {
@@ -81,16 +207,290 @@ namespace SST {
                 return instLen;
             }
 
-            char* getBinaryBuffer() {
-                return programBinary;
+            // instLen bytes of text, loaded at address dataLen
+            const char* getTextBuffer() {
+                return textBinary;
+            }
+
+            // Everything memory must be initialized with, the data extents
+            // then the text. Addresses not covered read as zero.
+            size_t getExtentCount() const {
+                return extents.size();
+            }
+
+            const JunoProgramExtent& getExtent( const size_t index ) const {
+                return extents[index];
+            }
+
+            // Name of the closest code symbol at or before addr, offset is
+            // set to the distance from it. NULL when there is no symbol.
+            const char* findSymbol( const uint64_t addr, uint64_t* offset ) const {
+                uint64_t low  = 0;
+                uint64_t high = symbolCount;
+
+                // Symbols are sorted by address, find the first one above addr
+                while( low < high ) {
+                    const uint64_t mid = low + ((high - low) / 2);
+
+                    if( symbolAddress( mid ) <= addr ) {
+                        low = mid + 1;
+                    } else {
+                        high = mid;
+                    }
+                }
+
+                while( low > 0 ) {
+                    low--;
+
+                    uint32_t kind = 0;
+                    memcpy( (void*) &kind, &symbolTable[(low * JUNO_SYMBOL_ENTRY_LEN) + 8], sizeof(kind) );
+
+                    if( JUNO_SYMBOL_CODE == kind ) {
+                        uint32_t nameOffset = 0;
+                        memcpy( (void*) &nameOffset, &symbolTable[(low * JUNO_SYMBOL_ENTRY_LEN) + 12], sizeof(nameOffset) );
+
+                        *offset = addr - symbolAddress( low );
+                        return &symbolNames[nameOffset];
+                    }
+                }
+
+                return NULL;
+            }
+
+            // Source line of the instruction at pc, 0 when it is not known
+            uint32_t findSourceLine( const uint64_t pc ) const {
+                if( pc < dataLen || (pc - dataLen) / 4 >= lineCount ) {
+                    return 0;
+                }
+
+                uint32_t line = 0;
+                memcpy( (void*) &line, &lineTable[((pc - dataLen) / 4) * sizeof(uint32_t)], sizeof(line) );
+
+                return line;
             }
 
         protected:
+            void readSparseData( const char* fileImage, const int64_t headerLen, SST::Output* output ) {
+                uint64_t extentCount = 0;
+                size_t offset = static_cast<size_t>( headerLen );
+
+                if( (mapLength - offset) < sizeof(extentCount) ) {
+                    output->fatal(CALL_INFO, -1, "Error: program binary is truncated, no extent count\n");
+                }
+
+                memcpy( (void*) &extentCount, &fileImage[offset], sizeof(extentCount) );
+                offset += sizeof(extentCount);
+
+                if( extentCount > (mapLength - offset) / (2 * sizeof(uint64_t)) ) {
+                    output->fatal(CALL_INFO, -1, "Error: program binary is truncated, expected %" PRIu64 " extents\n", extentCount);
+                }
+
+                size_t payload = offset + static_cast<size_t>( extentCount ) * 2 * sizeof(uint64_t);
+
+                for( uint64_t i = 0; i < extentCount; ++i ) {
+                    uint64_t extentAddr = 0;
+                    uint64_t extentLen  = 0;
+
+                    memcpy( (void*) &extentAddr, &fileImage[offset], sizeof(extentAddr) );
+                    memcpy( (void*) &extentLen, &fileImage[offset + sizeof(extentAddr)], sizeof(extentLen) );
+                    offset += 2 * sizeof(uint64_t);
+
+                    if( extentAddr > dataLen || extentLen > (dataLen - extentAddr) ) {
+                        output->fatal(CALL_INFO, -1, "Error: extent at %" PRIu64 " of %" PRIu64 " bytes is outside the %" PRIu64 " bytes of data\n",
+                            extentAddr, extentLen, dataLen);
+                    }
+
+                    if( extentLen > (mapLength - payload) ) {
+                        output->fatal(CALL_INFO, -1, "Error: program binary is truncated in the extent at %" PRIu64 "\n", extentAddr);
+                    }
+
+                    addExtent( extentAddr, &fileImage[payload], extentLen );
+                    payload += static_cast<size_t>( extentLen );
+                }
+
+                if( instLen > (mapLength - payload) ) {
+                    output->fatal(CALL_INFO, -1, "Error: program binary is truncated, expected %" PRIu64 " bytes of text but found %" PRIu64 "\n",
+                        instLen, static_cast<uint64_t>( mapLength - payload ));
+                }
+
+                textBinary = &fileImage[payload];
+            }
+
+            void readSections( const char* fileImage, const int64_t headerLen, SST::Output* output ) {
+                uint64_t sectionCount = 0;
+                size_t offset = static_cast<size_t>( headerLen );
+
+                if( (mapLength - offset) < sizeof(sectionCount) ) {
+                    output->fatal(CALL_INFO, -1, "Error: program binary is truncated, no section count\n");
+                }
+
+                memcpy( (void*) &sectionCount, &fileImage[offset], sizeof(sectionCount) );
+                offset += sizeof(sectionCount);
+
+                if( sectionCount > (mapLength - offset) / JUNO_SECTION_ENTRY_LEN ) {
+                    output->fatal(CALL_INFO, -1, "Error: program binary is truncated, expected %" PRIu64 " sections\n", sectionCount);
+                }
+
+                uint64_t bssBytes = 0;
+
+                for( uint64_t i = 0; i < sectionCount; ++i ) {
+                    uint32_t sectionType = 0;
+                    uint64_t sectionAddr = 0;
+                    uint64_t fileOffset  = 0;
+                    uint64_t sectionSize = 0;
+
+                    memcpy( (void*) &sectionType, &fileImage[offset], sizeof(sectionType) );
+                    memcpy( (void*) &sectionAddr, &fileImage[offset + 8], sizeof(sectionAddr) );
+                    memcpy( (void*) &fileOffset, &fileImage[offset + 16], sizeof(fileOffset) );
+                    memcpy( (void*) &sectionSize, &fileImage[offset + 24], sizeof(sectionSize) );
+                    offset += JUNO_SECTION_ENTRY_LEN;
+
+                    output->verbose(CALL_INFO, 2, 0, " -> section %" PRIu32 " at %8" PRIu64 " : %" PRIu64 " bytes\n",
+                        sectionType, sectionAddr, sectionSize);
+
+                    if( JUNO_SECTION_BSS == sectionType ) {
+                        bssBytes += sectionSize;
+                        continue;
+                    }
+
+                    if( fileOffset > mapLength || sectionSize > (mapLength - fileOffset) ) {
+                        output->fatal(CALL_INFO, -1, "Error: program binary is truncated in section %" PRIu64 "\n", i);
+                    }
+
+                    const char* payload = &fileImage[fileOffset];
+
+                    switch( sectionType ) {
+                    case JUNO_SECTION_TEXT:
+                        if( sectionAddr != dataLen || sectionSize != instLen ) {
+                            output->fatal(CALL_INFO, -1, "Error: text section at %" PRIu64 " of %" PRIu64 " bytes does not follow the %" PRIu64 " bytes of data\n",
+                                sectionAddr, sectionSize, dataLen);
+                        }
+
+                        textBinary = payload;
+                        break;
+
+                    case JUNO_SECTION_DATA:
+                        if( sectionAddr > dataLen || sectionSize > (dataLen - sectionAddr) ) {
+                            output->fatal(CALL_INFO, -1, "Error: data section at %" PRIu64 " of %" PRIu64 " bytes is outside the %" PRIu64 " bytes of data\n",
+                                sectionAddr, sectionSize, dataLen);
+                        }
+
+                        addExtent( sectionAddr, payload, sectionSize );
+                        break;
+
+                    case JUNO_SECTION_SYMBOLS:
+                        readSymbols( payload, sectionSize, output );
+                        break;
+
+                    case JUNO_SECTION_LINES:
+                        if( sectionSize < sizeof(lineCount) ) {
+                            output->fatal(CALL_INFO, -1, "Error: line table is too short\n");
+                        }
+
+                        memcpy( (void*) &lineCount, payload, sizeof(lineCount) );
+
+                        if( lineCount > (sectionSize - sizeof(lineCount)) / sizeof(uint32_t) ) {
+                            output->fatal(CALL_INFO, -1, "Error: line table is truncated, expected %" PRIu64 " lines\n", lineCount);
+                        }
+
+                        lineTable = &payload[sizeof(lineCount)];
+                        break;
+
+                    default:
+                        // Sections from newer assemblers which are not needed to run
+                        output->verbose(CALL_INFO, 1, 0, "Skipping section %" PRIu64 " of unknown type %" PRIu32 "\n", i, sectionType);
+                        break;
+                    }
+                }
+
+                if( instLen > 0 && NULL == textBinary ) {
+                    output->fatal(CALL_INFO, -1, "Error: program binary has %" PRIu64 " bytes of text but no text section\n", instLen);
+                }
+
+                output->verbose(CALL_INFO, 1, 0, "BSS:                      %" PRIu64 " bytes\n", bssBytes);
+                output->verbose(CALL_INFO, 1, 0, "Symbols:                  %" PRIu64 ", source lines: %" PRIu64 "\n",
+                    symbolCount, lineCount);
+            }
+
+            void readSymbols( const char* payload, const uint64_t size, SST::Output* output ) {
+                if( size < sizeof(symbolCount) ) {
+                    output->fatal(CALL_INFO, -1, "Error: symbol table is too short\n");
+                }
+
+                memcpy( (void*) &symbolCount, payload, sizeof(symbolCount) );
+
+                if( symbolCount > (size - sizeof(symbolCount)) / JUNO_SYMBOL_ENTRY_LEN ) {
+                    output->fatal(CALL_INFO, -1, "Error: symbol table is truncated, expected %" PRIu64 " symbols\n", symbolCount);
+                }
+
+                symbolTable    = &payload[sizeof(symbolCount)];
+                symbolNames    = &symbolTable[symbolCount * JUNO_SYMBOL_ENTRY_LEN];
+                symbolNamesLen = size - sizeof(symbolCount) - (symbolCount * JUNO_SYMBOL_ENTRY_LEN);
+
+                // Every name must end inside the table so lookups can hand
+                // out pointers to them directly
+                for( uint64_t i = 0; i < symbolCount; ++i ) {
+                    uint32_t nameOffset = 0;
+                    memcpy( (void*) &nameOffset, &symbolTable[(i * JUNO_SYMBOL_ENTRY_LEN) + 12], sizeof(nameOffset) );
+
+                    if( nameOffset >= symbolNamesLen ||
+                        NULL == memchr( &symbolNames[nameOffset], '\0', symbolNamesLen - nameOffset ) ) {
+                        output->fatal(CALL_INFO, -1, "Error: symbol %" PRIu64 " has a name outside the symbol table\n", i);
+                    }
+                }
+            }
+
+            uint64_t symbolAddress( const uint64_t index ) const {
+                uint64_t addr = 0;
+                memcpy( (void*) &addr, &symbolTable[index * JUNO_SYMBOL_ENTRY_LEN], sizeof(addr) );
+
+                return addr;
+            }
+
+            // Keeps the non-zero parts of bytes, long zero runs are dropped
+            // as memory starts out zeroed
+            void addExtent( const uint64_t addr, const char* bytes, const uint64_t len ) {
+                uint64_t start = 0;
+
+                while( start < len ) {
+                    while( start < len && 0 == bytes[start] ) {
+                        start++;
+                    }
+
+                    uint64_t end = start;
+                    uint64_t zeroRun = 0;
+
+                    while( end < len && zeroRun < JUNO_MIN_ZERO_RUN ) {
+                        zeroRun = (0 == bytes[end]) ? (zeroRun + 1) : 0;
+                        end++;
+                    }
+
+                    end -= zeroRun;
+
+                    if( end > start ) {
+                        JunoProgramExtent extent = { addr + start, end - start, &bytes[start] };
+                        extents.push_back( extent );
+                    }
+
+                    start = end;
+                }
+            }
+
             int64_t  binVersion;
             uint64_t dataLen;
             uint64_t instLen;
 	    uint64_t padding;
-            char* programBinary;
+            void* mapBase;
+            size_t mapLength;
+            char* readBuffer;
+            const char* textBinary;
+            const char* symbolTable;
+            uint64_t symbolCount;
+            const char* symbolNames;
+            uint64_t symbolNamesLen;
+            const char* lineTable;
+            uint64_t lineCount;
+            std::vector<JunoProgramExtent> extents;
         };
         
     }
@@ -19,10 +19,17 @@
 #define _H_SST_JUNO_REG_FILE_
 
 #include <cinttypes>
+#include <cstdlib>
+#include "junoverbose.h"
 
 namespace SST {
 namespace Juno {
 
+// Register values and scoreboard bits are held in separate flat arrays.
+// r0 (PC) and r1 (dynamic data start) are mirrored into the value array so
+// reads and writes are plain indexed accesses. Register numbers are
+// validated when instructions are decoded (JunoCPU::validateInstruction)
+// so they are not checked again here.
 class JunoRegisterFile {
 
 public:
@@ -33,13 +40,28 @@ public:
 
 		output->verbose(CALL_INFO, 2, 0, "Creating %d registers...\n", regCount);
 
-		registers = (int64_t*) malloc( sizeof(int64_t) * regCount );
+		// Always room for the two reserved registers, rounded to whole
+		// cache lines of values
+		allocatedRegs = static_cast<size_t>( (regCount < 2) ? 2 : regCount );
+		allocatedRegs = (allocatedRegs + 7) & ~static_cast<size_t>(7);
+
+		void* regBase     = NULL;
+		void* pendingBase = NULL;
+
+		if( 0 != posix_memalign( &regBase, 64, sizeof(int64_t) * allocatedRegs ) ||
+			0 != posix_memalign( &pendingBase, 64, sizeof(uint8_t) * allocatedRegs ) ) {
+			output->fatal(CALL_INFO, -1, "Error: unable to allocate %d registers\n", regCount);
+		}
+
+		registers = static_cast<int64_t*>( regBase );
+		pending   = static_cast<uint8_t*>( pendingBase );
 		clear();
 	}
 
 	~JunoRegisterFile() {
 		printRegisters();
 		free(registers);
+		free(pending);
 	}
 
 	void printRegisters() {
@@ -56,32 +78,62 @@ public:
 	}
 
 	void clear() {
-		for(int i = 0; i < maxReg; ++i) {
+		for( size_t i = 0; i < allocatedRegs; ++i ) {
 			registers[i] = 0;
+			pending[i]   = 0;
 		}
+
+		syncPC();
+		registers[1] = static_cast<int64_t>(dynDataLoc);
 	}
 
-	int64_t readReg(const uint8_t reg) const {
-		if( 0 == reg ) {
-			return static_cast<int64_t>( *pc );
-		} else if( 1 == reg ) {
-			return static_cast<int64_t>(dynDataLoc);
-		} else {
-			return registers[reg];
+	int getRegisterCount() const {
+		return maxReg;
+	}
+
+	// True if reg can be named by an instruction, r0 and r1 always exist
+	bool isValidRegister(const uint8_t reg) const {
+		return (reg < 2) || (reg < maxReg);
+	}
+
+	// Copy the current PC into r0, called before each instruction executes
+	void syncPC() {
+		registers[0] = static_cast<int64_t>( *pc );
+	}
+
+	// Scoreboard, a register is pending while a load into it is in flight
+	bool isPending(const uint8_t reg) const {
+		return 0 != pending[reg];
+	}
+
+	// True if any of count registers from reg is pending, for the
+	// register groups of vector loads and stores
+	bool isPending(const uint8_t reg, const uint8_t count) const {
+		for( uint8_t i = 0; i < count; ++i ) {
+			if( 0 != pending[reg + i] ) {
+				return true;
+			}
 		}
+
+		return false;
+	}
+
+	void setPending(const uint8_t reg) {
+		pending[reg] = 1;
+	}
+
+	void clearPending(const uint8_t reg) {
+		pending[reg] = 0;
+	}
+
+	int64_t readReg(const uint8_t reg) const {
+		return registers[reg];
 	}
 
 	void writeReg(const uint8_t reg, int64_t val) {
-		if( reg >= maxReg ) {
-			output->fatal(CALL_INFO, -1, "Accessed register %" PRIu8 ", but max is: %d.\n", reg, maxReg);
-		} else if( reg <= 1 ) {
-			output->fatal(CALL_INFO, -1, "Attempting write to register %" PRIu8 " but r0 and r1 are hardware reserved.\n",
-				reg);
-		} else {
-			output->verbose(CALL_INFO, 16, 0, "Writing %" PRId64 " into register %" PRIu8 "...\n",
-				val, reg);
-			registers[reg] = val;
-		}
+		JUNO_VERBOSE(*output, 16, "Writing %" PRId64 " into register %" PRIu8 "...\n",
+			val, reg);
+		registers[reg] = val;
 	}
 
 protected:
@@ -89,7 +141,9 @@ protected:
 	SST::Output* output;
 	const int maxReg;
 	uint64_t dynDataLoc;
+	size_t allocatedRegs;
 	int64_t* registers;
+	uint8_t* pending;
 
 };
 
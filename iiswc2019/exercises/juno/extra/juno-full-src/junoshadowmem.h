@@ -0,0 +1,192 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_SHADOW_MEM
+#define _H_SST_JUNO_SHADOW_MEM
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace SST {
+namespace Juno {
+
+// A run of bytes stored while fast-forwarding, which memory does not have
+class JunoShadowRun {
+
+public:
+	JunoShadowRun( const uint64_t runAddr, const uint64_t runLength ) :
+		addr(runAddr), length(runLength) {}
+
+	uint64_t addr;
+	uint64_t length;
+
+};
+
+class JunoShadowPage {
+
+public:
+	JunoShadowPage( const uint64_t pageSize ) :
+		bytes( pageSize, 0 ), dirty( pageSize / 64, 0 ), listed(false) {}
+
+	std::vector<uint8_t> bytes;
+	// One bit per byte written with markDirty set
+	std::vector<uint64_t> dirty;
+	bool listed;
+
+};
+
+// Functional copy of the memory image held inside the CPU, used when
+// instructions are executed without timing (fast-forward). Pages are only
+// allocated when they are first written so a sparse address space is cheap.
+// Bytes written with markDirty set are remembered until takeDirtyRuns so
+// they can be sent to memory in one go.
+class JunoShadowMemory {
+
+public:
+	JunoShadowMemory() :
+		lastPageNum(0), lastPage(NULL) {}
+
+	~JunoShadowMemory() {}
+
+	int64_t read64( const uint64_t addr ) {
+		int64_t value = 0;
+		read( addr, reinterpret_cast<uint8_t*>( &value ), sizeof(value) );
+		return value;
+	}
+
+	void write64( const uint64_t addr, const int64_t value, const bool markDirty = false ) {
+		write( addr, reinterpret_cast<const uint8_t*>( &value ), sizeof(value), markDirty );
+	}
+
+	void read( const uint64_t addr, uint8_t* data, const uint64_t len ) {
+		for( uint64_t i = 0; i < len; ) {
+			const uint64_t offset = (addr + i) & JUNO_SHADOW_PAGE_MASK;
+			const uint64_t chunk  = std::min( len - i, JUNO_SHADOW_PAGE_SIZE - offset );
+			const JunoShadowPage* page = findPage( (addr + i) >> JUNO_SHADOW_PAGE_SHIFT, false );
+
+			if( NULL == page ) {
+				memset( &data[i], 0, chunk );
+			} else {
+				memcpy( &data[i], &page->bytes[offset], chunk );
+			}
+
+			i += chunk;
+		}
+	}
+
+	void write( const uint64_t addr, const uint8_t* data, const uint64_t len, const bool markDirty = false ) {
+		for( uint64_t i = 0; i < len; ) {
+			const uint64_t pageNum = (addr + i) >> JUNO_SHADOW_PAGE_SHIFT;
+			const uint64_t offset  = (addr + i) & JUNO_SHADOW_PAGE_MASK;
+			const uint64_t chunk   = std::min( len - i, JUNO_SHADOW_PAGE_SIZE - offset );
+			JunoShadowPage* page   = findPage( pageNum, true );
+
+			memcpy( &page->bytes[offset], &data[i], chunk );
+
+			if( markDirty ) {
+				for( uint64_t b = offset; b < offset + chunk; ++b ) {
+					page->dirty[b / 64] |= (static_cast<uint64_t>(1) << (b % 64));
+				}
+
+				if( ! page->listed ) {
+					page->listed = true;
+					dirtyPages.push_back( pageNum );
+				}
+			}
+
+			i += chunk;
+		}
+	}
+
+	// Appends every run of dirty bytes to runs, split so that none
+	// crosses a lineBytes boundary, and marks them clean
+	void takeDirtyRuns( const uint64_t lineBytes, std::vector<JunoShadowRun>& runs ) {
+		for( size_t p = 0; p < dirtyPages.size(); ++p ) {
+			JunoShadowPage* page   = findPage( dirtyPages[p], false );
+			const uint64_t pageAddr = dirtyPages[p] << JUNO_SHADOW_PAGE_SHIFT;
+			uint64_t byte = 0;
+
+			while( byte < JUNO_SHADOW_PAGE_SIZE ) {
+				if( 0 == page->dirty[byte / 64] ) {
+					byte = (byte / 64 + 1) * 64;
+					continue;
+				}
+
+				if( 0 == (page->dirty[byte / 64] & (static_cast<uint64_t>(1) << (byte % 64))) ) {
+					byte++;
+					continue;
+				}
+
+				uint64_t runEnd = byte;
+
+				do {
+					runEnd++;
+				} while( runEnd < JUNO_SHADOW_PAGE_SIZE && 0 != (runEnd % lineBytes) &&
+					0 != (page->dirty[runEnd / 64] & (static_cast<uint64_t>(1) << (runEnd % 64))) );
+
+				runs.push_back( JunoShadowRun( pageAddr + byte, runEnd - byte ) );
+				byte = runEnd;
+			}
+
+			std::fill( page->dirty.begin(), page->dirty.end(), 0 );
+			page->listed = false;
+		}
+
+		dirtyPages.clear();
+	}
+
+protected:
+	static const uint64_t JUNO_SHADOW_PAGE_SHIFT = 12;
+	static const uint64_t JUNO_SHADOW_PAGE_SIZE  = static_cast<uint64_t>(1) << JUNO_SHADOW_PAGE_SHIFT;
+	static const uint64_t JUNO_SHADOW_PAGE_MASK  = JUNO_SHADOW_PAGE_SIZE - 1;
+
+	JunoShadowPage* findPage( const uint64_t pageNum, const bool create ) {
+		if( NULL != lastPage && pageNum == lastPageNum ) {
+			return lastPage;
+		}
+
+		auto pageItr = pages.find( pageNum );
+
+		if( pageItr == pages.end() ) {
+			if( ! create ) {
+				return NULL;
+			}
+
+			pageItr = pages.insert( std::make_pair( pageNum,
+				JunoShadowPage( JUNO_SHADOW_PAGE_SIZE ) ) ).first;
+		}
+
+		lastPageNum = pageNum;
+		lastPage    = &(pageItr->second);
+
+		return lastPage;
+	}
+
+	std::unordered_map< uint64_t, JunoShadowPage > pages;
+	std::vector<uint64_t> dirtyPages;
+	uint64_t lastPageNum;
+	JunoShadowPage* lastPage;
+
+};
+
+}
+}
+
+#endif
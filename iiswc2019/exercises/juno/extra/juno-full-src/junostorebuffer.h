@@ -0,0 +1,354 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_STORE_BUFFER
+#define _H_SST_JUNO_STORE_BUFFER
+
+#include <sst/core/interfaces/simpleMem.h>
+#include <cinttypes>
+#include <vector>
+
+#include "junoopcodes.h"
+#include "junoverbose.h"
+using namespace SST::Interfaces;
+
+namespace SST {
+    namespace Juno {
+
+        enum JunoStoreBufferState {
+            JUNO_SB_FREE,
+            JUNO_SB_BUFFERED,
+            JUNO_SB_WRITING
+        };
+
+        enum JunoStoreForward {
+            JUNO_SB_MISS,
+            JUNO_SB_HIT,
+            JUNO_SB_CONFLICT
+        };
+
+        // One cache line of buffered store data, mask has a bit set for
+        // every byte which has been written
+        class JunoStoreBufferEntry {
+
+        public:
+            JunoStoreBufferEntry() :
+                lineAddr(0), mask(0), state(JUNO_SB_FREE), age(0) {}
+
+            uint64_t lineAddr;
+            uint64_t mask;
+            JunoStoreBufferState state;
+            uint64_t age;
+            std::vector<uint8_t> data;
+            std::vector<SimpleMem::Request::id_t> writeIDs;
+
+        };
+
+        class JunoStoreBuffer {
+
+        public:
+            JunoStoreBuffer( SST::Output* out, SimpleMem* smMem, const uint32_t depth, const uint64_t lineBytes,
+                Statistic<uint64_t>* writeStat, Statistic<uint64_t>* combineStat, Statistic<uint64_t>* forwardStat ) :
+                output(out), mem(smMem), lineSize(lineBytes), entriesUsed(0), nextAge(0),
+                statWrites(writeStat), statCombined(combineStat), statForwards(forwardStat) {
+
+                if( lineSize < 8 || lineSize > 64 || (0 != (lineSize & (lineSize - 1))) ) {
+                    output->fatal(CALL_INFO, -1, "Error: store buffer line size (%" PRIu64 ") must be a power of two from 8 to 64 bytes\n",
+                        lineSize);
+                }
+
+                // Every line a single store touches has to fit at once, an
+                // unaligned vector store of the most registers is the worst
+                const uint64_t maxStoreBytes = static_cast<uint64_t>(JUNO_VECTOR_MAX_REGS) * 8;
+                const uint64_t minDepth = (maxStoreBytes + lineSize - 1) / lineSize + 1;
+
+                if( depth < minDepth ) {
+                    output->fatal(CALL_INFO, -1, "Error: store buffer depth (%" PRIu32 ") must be at least %" PRIu64 ", a %" PRIu64 " byte vector store can touch that many %" PRIu64 " byte lines\n",
+                        depth, minDepth, maxStoreBytes, lineSize);
+                }
+
+                fullMask = (64 == lineSize) ? UINT64_MAX : ((static_cast<uint64_t>(1) << lineSize) - 1);
+
+                entries.resize( depth );
+
+                for( size_t i = 0; i < entries.size(); ++i ) {
+                    entries[i].data.resize( lineSize );
+                    entries[i].writeIDs.reserve( lineSize / 2 );
+                }
+            }
+
+            ~JunoStoreBuffer() {}
+
+            bool empty() const {
+                return 0 == entriesUsed;
+            }
+
+            // A store can enter the buffer if every line it touches is
+            // already buffered (combining) or a free entry is available.
+            // Lines being written out are not reopened so two writes to
+            // the same bytes are never in flight together.
+            bool canAccept( const uint64_t addr, const uint64_t len ) const {
+                uint32_t needed = 0;
+
+                for( uint64_t line = lineOf( addr ); line < addr + len; line += lineSize ) {
+                    const int index = findLine( line );
+
+                    if( index < 0 ) {
+                        needed++;
+                    } else if( JUNO_SB_WRITING == entries[index].state ) {
+                        return false;
+                    }
+                }
+
+                return needed <= (entries.size() - entriesUsed);
+            }
+
+            // True if a line the store touches is being written out, the
+            // store waits for that write rather than for a free entry
+            bool isWriting( const uint64_t addr, const uint64_t len ) const {
+                for( uint64_t line = lineOf( addr ); line < addr + len; line += lineSize ) {
+                    const int index = findLine( line );
+
+                    if( index >= 0 && JUNO_SB_WRITING == entries[index].state ) {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            void insert( const uint64_t addr, const uint8_t* bytes, const uint64_t len ) {
+                for( uint64_t i = 0; i < len; ) {
+                    const uint64_t line = lineOf( addr + i );
+                    int index = findLine( line );
+
+                    if( index < 0 ) {
+                        index = allocate( line );
+                    } else {
+                        statCombined->addData(1);
+                    }
+
+                    JunoStoreBufferEntry& entry = entries[index];
+
+                    for( ; i < len; ++i ) {
+                        const uint64_t byte = (addr + i) - line;
+
+                        if( byte >= lineSize ) {
+                            break;
+                        }
+
+                        entry.data[byte] = bytes[i];
+                        entry.mask |= (static_cast<uint64_t>(1) << byte);
+                    }
+
+                    // Whole line written, nothing more can combine into it
+                    if( fullMask == entry.mask ) {
+                        writeOut( entry );
+                    }
+                }
+            }
+
+            // Check a load of [addr, addr+len) against the buffer, on a HIT
+            // every byte came from buffered stores and is copied to value
+            JunoStoreForward forward( const uint64_t addr, const uint64_t len, uint8_t* value ) const {
+                uint64_t covered = 0;
+                bool overlaps = false;
+
+                for( uint64_t i = 0; i < len; ++i ) {
+                    const uint64_t line = lineOf( addr + i );
+                    const int index = findLine( line );
+
+                    if( index < 0 ) {
+                        continue;
+                    }
+
+                    const JunoStoreBufferEntry& entry = entries[index];
+                    const uint64_t byte = (addr + i) - line;
+
+                    if( JUNO_SB_WRITING == entry.state ) {
+                        overlaps = true;
+                    } else if( 0 != (entry.mask & (static_cast<uint64_t>(1) << byte)) ) {
+                        if( NULL != value ) {
+                            value[i] = entry.data[byte];
+                        }
+
+                        covered++;
+                    }
+                }
+
+                if( len == covered ) {
+                    return JUNO_SB_HIT;
+                } else if( overlaps || covered > 0 ) {
+                    return JUNO_SB_CONFLICT;
+                } else {
+                    return JUNO_SB_MISS;
+                }
+            }
+
+            void recordForward() {
+                statForwards->addData(1);
+            }
+
+            // Write out every buffered line which overlaps [addr, addr+len)
+            void flush( const uint64_t addr, const uint64_t len ) {
+                for( uint64_t line = lineOf( addr ); line < addr + len; line += lineSize ) {
+                    const int index = findLine( line );
+
+                    if( index >= 0 && JUNO_SB_BUFFERED == entries[index].state ) {
+                        writeOut( entries[index] );
+                    }
+                }
+            }
+
+            void flushAll() {
+                for( size_t i = 0; i < entries.size(); ++i ) {
+                    if( JUNO_SB_BUFFERED == entries[i].state ) {
+                        writeOut( entries[i] );
+                    }
+                }
+            }
+
+            // Make space for a new line by writing out the oldest one,
+            // returns false if every line is already being written
+            bool evictOldest() {
+                int oldest = -1;
+
+                for( size_t i = 0; i < entries.size(); ++i ) {
+                    if( JUNO_SB_BUFFERED == entries[i].state &&
+                        (oldest < 0 || entries[i].age < entries[oldest].age) ) {
+                        oldest = static_cast<int>(i);
+                    }
+                }
+
+                if( oldest < 0 ) {
+                    return false;
+                }
+
+                writeOut( entries[oldest] );
+                return true;
+            }
+
+            // Returns true if the response belongs to a buffer write
+            bool handleResponse( const SimpleMem::Request::id_t id ) {
+                for( size_t i = 0; i < entries.size(); ++i ) {
+                    JunoStoreBufferEntry& entry = entries[i];
+
+                    if( JUNO_SB_WRITING != entry.state ) {
+                        continue;
+                    }
+
+                    for( size_t j = 0; j < entry.writeIDs.size(); ++j ) {
+                        if( entry.writeIDs[j] == id ) {
+                            entry.writeIDs[j] = entry.writeIDs.back();
+                            entry.writeIDs.pop_back();
+
+                            if( entry.writeIDs.empty() ) {
+                                entry.state = JUNO_SB_FREE;
+                                entry.mask  = 0;
+                                entriesUsed--;
+                            }
+
+                            return true;
+                        }
+                    }
+                }
+
+                return false;
+            }
+
+        protected:
+            uint64_t lineOf( const uint64_t addr ) const {
+                return addr & ~(lineSize - 1);
+            }
+
+            int findLine( const uint64_t line ) const {
+                for( size_t i = 0; i < entries.size(); ++i ) {
+                    if( JUNO_SB_FREE != entries[i].state && line == entries[i].lineAddr ) {
+                        return static_cast<int>(i);
+                    }
+                }
+
+                return -1;
+            }
+
+            int allocate( const uint64_t line ) {
+                for( size_t i = 0; i < entries.size(); ++i ) {
+                    if( JUNO_SB_FREE == entries[i].state ) {
+                        entries[i].state    = JUNO_SB_BUFFERED;
+                        entries[i].lineAddr = line;
+                        entries[i].mask     = 0;
+                        entries[i].age      = nextAge++;
+                        entriesUsed++;
+
+                        return static_cast<int>(i);
+                    }
+                }
+
+                output->fatal(CALL_INFO, -1, "Error: store buffer has no free entry for line %" PRIu64 "\n", line);
+                return -1;
+            }
+
+            // Send each contiguous run of written bytes as one request
+            void writeOut( JunoStoreBufferEntry& entry ) {
+                JUNO_VERBOSE(*output, 16, "Store buffer writing line %" PRIu64 " (mask 0x%" PRIx64 ")\n",
+                    entry.lineAddr, entry.mask);
+
+                uint64_t byte = 0;
+
+                while( byte < lineSize ) {
+                    if( 0 == (entry.mask & (static_cast<uint64_t>(1) << byte)) ) {
+                        byte++;
+                        continue;
+                    }
+
+                    uint64_t runEnd = byte;
+
+                    while( runEnd < lineSize && 0 != (entry.mask & (static_cast<uint64_t>(1) << runEnd)) ) {
+                        runEnd++;
+                    }
+
+                    std::vector<uint8_t> payload( entry.data.begin() + byte, entry.data.begin() + runEnd );
+                    SimpleMem::Request* req = new SimpleMem::Request( SimpleMem::Request::Write,
+                        entry.lineAddr + byte, runEnd - byte, payload );
+
+                    entry.writeIDs.push_back( req->id );
+                    statWrites->addData(1);
+
+                    mem->sendRequest( req );
+                    byte = runEnd;
+                }
+
+                entry.state = JUNO_SB_WRITING;
+            }
+
+            SST::Output* output;
+            SimpleMem* mem;
+            const uint64_t lineSize;
+            uint64_t fullMask;
+            uint32_t entriesUsed;
+            uint64_t nextAge;
+            std::vector<JunoStoreBufferEntry> entries;
+            Statistic<uint64_t>* statWrites;
+            Statistic<uint64_t>* statCombined;
+            Statistic<uint64_t>* statForwards;
+
+        };
+
+    }
+}
+
+#endif
@@ -0,0 +1,38 @@
+// Copyright 2013-2018 NTESS. Under the terms
+// of Contract DE-NA0003525 with NTESS, the U.S.
+// Government retains certain rights in this software.
+//
+// Copyright (c) 2013-2018, NTESS
+// All rights reserved.
+//
+// Portions are copyright of other developers:
+// See the file CONTRIBUTORS.TXT in the top level directory
+// the distribution for more information.
+//
+// This file is part of the SST software package. For license
+// information, see the LICENSE file in the top level directory of the
+// distribution.
+
+
+
+#ifndef _H_SST_JUNO_VERBOSE
+#define _H_SST_JUNO_VERBOSE
+
+// Highest verbosity level compiled into the per-instruction paths. Messages
+// above it are removed at build time, including the evaluation of their
+// arguments. Build with -DJUNO_MAX_VERBOSE=64 (make JUNO_MAX_VERBOSE=64) to
+// get every message back for debugging.
+#ifndef JUNO_MAX_VERBOSE
+#define JUNO_MAX_VERBOSE 1
+#endif
+
+// Arguments are only evaluated if the level is compiled in and enabled at
+// run time
+#define JUNO_VERBOSE(out, level, ...) \
+	do { \
+		if( ((level) <= JUNO_MAX_VERBOSE) && ((out).getVerboseLevel() >= static_cast<uint32_t>(level)) ) { \
+			(out).verbose(CALL_INFO, level, 0, __VA_ARGS__); \
+		} \
+	} while(0)
+
+#endif